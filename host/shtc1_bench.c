@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 host benchmark
+ *
+ * This program measures the driver on the simulated transport of shtc1_sim
+ * with the synchronous read, which waits for the maximum conversion time,
+ * the split read polling for the result, the non-blocking state machine and
+ * the pipelined scheduler. For each it reports the samples per second and
+ * the bus utilization on the virtual clock, plus the host CPU time the
+ * driver and the simulation spend per sample. Waits only advance the
+ * virtual clock, so the CPU time does not include them.
+ */
+
+ #include <stdio.h>
+ #include <time.h>
+ #include "shtc1.h"
+ #include "shtc1_async.h"
+ #include "shtc1_sched.h"
+ #include "shtc1_sim.h"
+ 
+ /* samples taken per benchmark, the virtual clock wraps after about 71 minutes */
+ #define BENCH_SAMPLES 10000
+ /* sensors behind the multiplexer of the pipelined benchmark */
+ #define BENCH_SENSORS 4
+ 
+ struct bench_result {
+     uint32_t samples;
+     uint32_t failures;
+     uint32_t virtual_us;
+     uint16_t utilization;
+     clock_t cpu;
+ };
+ 
+ /* the timer of the non-blocking state machine, expired by the benchmark loop */
+ static struct shtc1_async *pending_timer;
+ static uint16_t pending_timeout_us;
+ static uint32_t async_samples;
+ static uint32_t async_failures;
+ 
+ static void bench_start_timer(struct shtc1_async *async, uint16_t timeout_us)
+ {
+     pending_timer = async;
+     pending_timeout_us = timeout_us;
+ }
+ 
+ static void bench_async_done(struct shtc1_async *async, enum status_code status,
+         int temp, int rh)
+ {
+     (void)async;
+     (void)temp;
+     (void)rh;
+     ++async_samples;
+     if (status)
+         ++async_failures;
+ }
+ 
+ static void bench_finish(struct bench_result *result, const struct shtc1_sim *sim,
+         clock_t start)
+ {
+     result->cpu = clock() - start;
+     result->virtual_us = sim->now_us;
+     result->utilization = shtc1_sim_get_utilization(sim);
+ }
+ 
+ static void bench_sync(struct bench_result *result, enum shtc1_mode mode)
+ {
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     clock_t start;
+     int temp;
+     int rh;
+ 
+     shtc1_sim_init(&sim, SHTC1_NO_MUX);
+     shtc1_init(&dev, &sim.transport, SHTC1_NO_MUX, 0);
+     dev.mode = mode;
+     result->failures = 0;
+ 
+     start = clock();
+     for (result->samples = 0; result->samples < BENCH_SAMPLES; ++result->samples) {
+         if (shtc1_read_sync(&dev, &temp, &rh))
+             ++result->failures;
+     }
+     bench_finish(result, &sim, start);
+ }
+ 
+ /* the result is read as soon as the sensor acknowledges, see shtc1_poll_result() */
+ static void bench_poll(struct bench_result *result, enum shtc1_mode mode)
+ {
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     struct shtc1_poll_config config;
+     clock_t start;
+     int temp;
+     int rh;
+ 
+     shtc1_sim_init(&sim, SHTC1_NO_MUX);
+     shtc1_init(&dev, &sim.transport, SHTC1_NO_MUX, 0);
+     dev.mode = mode;
+     shtc1_poll_get_config_defaults(&config, mode);
+     result->failures = 0;
+ 
+     start = clock();
+     for (result->samples = 0; result->samples < BENCH_SAMPLES; ++result->samples) {
+         if (shtc1_read_async(&dev) || shtc1_poll_result(&dev, &config, &temp, &rh))
+             ++result->failures;
+     }
+     bench_finish(result, &sim, start);
+ }
+ 
+ static void bench_state_machine(struct bench_result *result, enum shtc1_mode mode)
+ {
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     struct shtc1_async async;
+     struct shtc1_async *expired;
+     clock_t start;
+ 
+     shtc1_sim_init(&sim, SHTC1_NO_MUX);
+     shtc1_init(&dev, &sim.transport, SHTC1_NO_MUX, 0);
+     shtc1_async_init(&async, &dev, bench_start_timer, bench_async_done);
+     async_samples = 0;
+     async_failures = 0;
+ 
+     start = clock();
+     while (async_samples < BENCH_SAMPLES) {
+         if (shtc1_async_start(&async, mode)) {
+             ++async_samples;
+             ++async_failures;
+             continue;
+         }
+         while (pending_timer) {
+             expired = pending_timer;
+             pending_timer = NULL;
+             sim.now_us += pending_timeout_us;
+             shtc1_async_timer_expired(expired);
+         }
+     }
+     bench_finish(result, &sim, start);
+     result->samples = async_samples;
+     result->failures = async_failures;
+ }
+ 
+ static void bench_pipelined(struct bench_result *result, enum shtc1_mode mode)
+ {
+     struct shtc1_sim sim;
+     struct shtc1_dev devs[BENCH_SENSORS];
+     struct shtc1_sched_result results[BENCH_SENSORS];
+     struct shtc1_sched sched;
+     clock_t start;
+     uint8_t i;
+ 
+     shtc1_sim_init(&sim, 0x74);
+     for (i = 0; i < BENCH_SENSORS; ++i) {
+         shtc1_sim_set_signals(&sim, i, 0x6666, 0x8000);
+         shtc1_init(&devs[i], &sim.transport, 0x74, i);
+     }
+     shtc1_sched_init(&sched, devs, results, BENCH_SENSORS);
+     result->samples = 0;
+     result->failures = 0;
+ 
+     start = clock();
+     while (result->samples < BENCH_SAMPLES) {
+         shtc1_sched_run(&sched, mode);
+         for (i = 0; i < BENCH_SENSORS; ++i) {
+             if (results[i].status)
+                 ++result->failures;
+         }
+         result->samples += BENCH_SENSORS;
+     }
+     bench_finish(result, &sim, start);
+ }
+ 
+ static void bench_print(const char *name, enum shtc1_mode mode,
+         const struct bench_result *result)
+ {
+     double seconds = result->virtual_us / 1e6;
+     double cpu_ns = (double)result->cpu * 1e9 / CLOCKS_PER_SEC / result->samples;
+ 
+     printf("%-14s %s %10.1f %12.0f %9.1f %9lu\n", name,
+             mode == SHTC1_MODE_HPM ? "HPM" : "LPM",
+             result->samples / seconds, cpu_ns, result->utilization / 10.0,
+             (unsigned long)result->failures);
+ }
+ 
+ int main(void)
+ {
+     static const enum shtc1_mode modes[] = { SHTC1_MODE_LPM, SHTC1_MODE_HPM };
+     struct bench_result result;
+     bool failed = false;
+     size_t i;
+ 
+     printf("%-14s %s %10s %12s %9s %9s\n", "path", "mode", "samples/s",
+             "cpu ns/sample", "bus %", "failures");
+     for (i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i) {
+         bench_sync(&result, modes[i]);
+         bench_print("sync", modes[i], &result);
+         failed |= result.failures != 0;
+         bench_poll(&result, modes[i]);
+         bench_print("async poll", modes[i], &result);
+         failed |= result.failures != 0;
+         bench_state_machine(&result, modes[i]);
+         bench_print("state machine", modes[i], &result);
+         failed |= result.failures != 0;
+         bench_pipelined(&result, modes[i]);
+         bench_print("pipelined x4", modes[i], &result);
+         failed |= result.failures != 0;
+     }
+     return failed ? 1 : 0;
+ }
\ No newline at end of file
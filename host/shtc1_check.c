@@ -0,0 +1,872 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 host checks
+ *
+ * This program runs the driver modules against the simulated transport of
+ * shtc1_sim and checks their results and timing on the virtual clock: the
+ * polled readout on the address NACK of a converting sensor, probing,
+ * retries with backoff, clock stretching with timeouts and bus recovery,
+ * sleep and wake windows, continuous, periodic and report-on-change
+ * sampling, the multi-bus engine, and the record, log, codec, filter and
+ * derived value modules. 'make check' builds it with and without
+ * SHTC1_CLOCK_STRETCHING and fails if any check fails.
+ */
+
+ #include <stdio.h>
+ #include <string.h>
+ #include "shtc1.h"
+ #include "shtc1_async.h"
+ #include "shtc1_codec.h"
+ #include "shtc1_continuous.h"
+ #include "shtc1_derived.h"
+ #include "shtc1_filter.h"
+ #include "shtc1_log.h"
+ #include "shtc1_multibus.h"
+ #include "shtc1_record.h"
+ #include "shtc1_sim.h"
+ 
+ /* signals of the simulated sensors, 25 C and 50 %RH */
+ #define CHECK_RAW_T  0x6666
+ #define CHECK_RAW_RH 0x8000
+ 
+ /* conversion timers that can be armed at the same time */
+ #define CHECK_TIMERS 4
+ 
+ /* pages of the simulated flash of the log checks */
+ #define CHECK_LOG_PAGES 8
+ 
+ #define CHECK(cond) check((cond), #cond, __LINE__)
+ 
+ static unsigned checks;
+ static unsigned failures;
+ 
+ static void check(bool ok, const char *expr, int line)
+ {
+     ++checks;
+     if (ok)
+         return;
+     ++failures;
+     printf("%s:%d: check failed: %s\n", __FILE__, line, expr);
+ }
+ 
+ /* results in the unit of SHTC1_OUTPUT_FORMAT */
+ static int check_temp(uint16_t raw_t)
+ {
+ #if SHTC1_OUTPUT_FORMAT == SHTC1_OUTPUT_CENTI
+     return shtc1_raw_to_centi_temp(raw_t);
+ #else
+     return shtc1_raw_to_milli_temp(raw_t);
+ #endif
+ }
+ 
+ static int check_rh(uint16_t raw_rh)
+ {
+ #if SHTC1_OUTPUT_FORMAT == SHTC1_OUTPUT_CENTI
+     return shtc1_raw_to_centi_rh(raw_rh);
+ #else
+     return shtc1_raw_to_milli_rh(raw_rh);
+ #endif
+ }
+ 
+ static void check_setup(struct shtc1_sim *sim, struct shtc1_dev *dev, enum shtc1_mode mode)
+ {
+     shtc1_sim_init(sim, SHTC1_NO_MUX);
+     shtc1_init(dev, &sim->transport, SHTC1_NO_MUX, 0);
+     dev->mode = mode;
+ }
+ 
+ /*
+  * The armed conversion timers of the non-blocking paths. Expiring a timer
+  * advances the virtual clock of the bus of its context, every context passed
+  * belongs to a device on a simulated transport.
+  */
+ static struct shtc1_async *pending[CHECK_TIMERS];
+ static uint16_t pending_us[CHECK_TIMERS];
+ static uint8_t pending_count;
+ 
+ static void check_start_timer(struct shtc1_async *async, uint16_t timeout_us)
+ {
+     CHECK(pending_count < CHECK_TIMERS);
+     if (pending_count >= CHECK_TIMERS)
+         return;
+     pending[pending_count] = async;
+     pending_us[pending_count] = timeout_us;
+     ++pending_count;
+ }
+ 
+ /* expires the armed timers in the order they were armed, at most max_timers */
+ static uint16_t check_run_timers(uint16_t max_timers)
+ {
+     struct shtc1_async *async;
+     struct shtc1_sim *sim;
+     uint16_t expired = 0;
+ 
+     while (pending_count && expired < max_timers) {
+         async = pending[0];
+         sim = (struct shtc1_sim *)async->dev->transport;
+         sim->now_us += pending_us[0];
+         --pending_count;
+         memmove(&pending[0], &pending[1], pending_count * sizeof(pending[0]));
+         memmove(&pending_us[0], &pending_us[1], pending_count * sizeof(pending_us[0]));
+         shtc1_async_timer_expired(async);
+         ++expired;
+     }
+     return expired;
+ }
+ 
+ static unsigned locks;
+ static unsigned unlocks;
+ 
+ static enum status_code check_lock(struct shtc1_transport *transport)
+ {
+     (void)transport;
+     ++locks;
+     return STATUS_OK;
+ }
+ 
+ static void check_unlock(struct shtc1_transport *transport)
+ {
+     (void)transport;
+     ++unlocks;
+ }
+ 
+ static void check_sync(void)
+ {
+     static const enum shtc1_mode modes[] = { SHTC1_MODE_LPM, SHTC1_MODE_HPM };
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     enum shtc1_mode mode;
+     uint32_t elapsed_us;
+     size_t i;
+     int temp;
+     int rh;
+ 
+     for (i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i) {
+         mode = modes[i];
+         check_setup(&sim, &dev, mode);
+         CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_OK);
+         CHECK(temp == check_temp(CHECK_RAW_T) && rh == check_rh(CHECK_RAW_RH));
+         elapsed_us = sim.now_us;
+         CHECK(elapsed_us >= sim.conversion_us[mode]);
+ #ifdef SHTC1_CLOCK_STRETCHING
+         /* the sensor releases the clock as soon as the conversion is done */
+         CHECK(elapsed_us <= sim.conversion_us[mode] + shtc1_get_bus_time_us(&dev));
+ #else
+         CHECK(elapsed_us >= shtc1_get_max_duration_us(mode));
+ #endif
+         CHECK(sim.nacks == 0);
+ 
+         /* with lock operations the bus is released during the conversion */
+         check_setup(&sim, &dev, mode);
+         sim.transport.lock = check_lock;
+         sim.transport.unlock = check_unlock;
+         locks = 0;
+         unlocks = 0;
+         CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_OK);
+         CHECK(locks > 0 && locks == unlocks);
+         CHECK(sim.now_us >= shtc1_get_max_duration_us(mode));
+     }
+ }
+ 
+ static void check_poll(void)
+ {
+     struct shtc1_poll_config config;
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     int temp;
+     int rh;
+ 
+     check_setup(&sim, &dev, SHTC1_MODE_HPM);
+     shtc1_poll_get_config_defaults(&config, SHTC1_MODE_HPM);
+     CHECK(shtc1_read_async(&dev) == STATUS_OK);
+     CHECK(shtc1_poll_result(&dev, &config, &temp, &rh) == STATUS_OK);
+     CHECK(temp == check_temp(CHECK_RAW_T) && rh == check_rh(CHECK_RAW_RH));
+     /* read shortly after the typical conversion time instead of the worst case */
+     CHECK(sim.nacks > 0);
+     CHECK(sim.now_us - dev.last_start_us >= sim.conversion_us[SHTC1_MODE_HPM]);
+     CHECK(sim.now_us - dev.last_start_us < shtc1_get_max_duration_us(SHTC1_MODE_HPM));
+ 
+     /* without a measurement the sensor never acknowledges a read */
+     CHECK(shtc1_poll_result(&dev, &config, &temp, &rh) == STATUS_ERR_TIMEOUT);
+ }
+ 
+ static void check_probe(void)
+ {
+     struct shtc1_sim sim;
+     struct shtc1_dev devs[SHTC1_SIM_SENSORS];
+     uint32_t presence;
+     uint8_t i;
+ 
+     shtc1_sim_init(&sim, 0x74);
+     shtc1_sim_set_signals(&sim, 2, CHECK_RAW_T, CHECK_RAW_RH);
+     shtc1_sim_set_signals(&sim, 5, CHECK_RAW_T, CHECK_RAW_RH);
+     for (i = 0; i < SHTC1_SIM_SENSORS; ++i)
+         shtc1_init(&devs[i], &sim.transport, 0x74, i);
+     CHECK(shtc1_probe_all(devs, SHTC1_SIM_SENSORS, &presence) == 3);
+     CHECK(presence == 0x25);
+ }
+ 
+ static void check_retry(void)
+ {
+     struct shtc1_retry_policy policy = { 0 };
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     uint32_t max_us = shtc1_get_max_duration_us(SHTC1_MODE_LPM);
+     int temp;
+     int rh;
+ #ifdef SHTC1_STATS
+     struct shtc1_stats stats;
+ #endif
+ 
+     /* without a policy a checksum error is returned */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     sim.sensors[0].corrupt = 1;
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_ERR_BAD_DATA);
+ 
+     /* two checksum errors, retried after 1 ms and 2 ms */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     sim.sensors[0].corrupt = 2;
+     policy.max_retries = 3;
+     policy.backoff_us = 1000;
+     shtc1_set_retry_policy(&dev, &policy);
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_OK);
+     CHECK(temp == check_temp(CHECK_RAW_T) && rh == check_rh(CHECK_RAW_RH));
+     CHECK(sim.now_us >= 3 * (uint32_t)sim.conversion_us[SHTC1_MODE_LPM] + 3000);
+ #ifndef SHTC1_CLOCK_STRETCHING
+     CHECK(sim.now_us >= 3 * max_us + 3000);
+ #endif
+ #ifdef SHTC1_STATS
+     shtc1_get_stats(&dev, &stats);
+     CHECK(stats.retries == 2);
+     CHECK(stats.crc_errors == 2);
+ #endif
+ 
+     /* the doubled backoff saturates at 100 ms: 60 + 100 + 100 ms */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     sim.sensors[0].present = false;
+     policy.max_retries = 3;
+     policy.backoff_us = 60000;
+     shtc1_set_retry_policy(&dev, &policy);
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_ERR_BAD_ADDRESS);
+     CHECK(sim.now_us >= 260000 && sim.now_us < 260000 + 4 * max_us);
+ }
+ 
+ #ifdef SHTC1_CLOCK_STRETCHING
+ static unsigned recoveries;
+ 
+ /* clocks out a stuck sensor, which then converts in its typical time again */
+ static enum status_code check_recover(struct shtc1_transport *transport)
+ {
+     struct shtc1_sim *sim = (struct shtc1_sim *)transport;
+ 
+     ++recoveries;
+     sim->conversion_us[SHTC1_MODE_HPM] = 10800;
+     return STATUS_OK;
+ }
+ 
+ static void check_timeout(void)
+ {
+     struct shtc1_retry_policy policy = { 0 };
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     int temp;
+     int rh;
+ #ifdef SHTC1_STATS
+     struct shtc1_stats stats;
+ #endif
+ 
+     /* a stuck sensor stretches the clock beyond the timeout */
+     check_setup(&sim, &dev, SHTC1_MODE_HPM);
+     sim.conversion_us[SHTC1_MODE_HPM] = 30000;
+     shtc1_set_timeout(&dev, 12000);
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_ERR_TIMEOUT);
+     CHECK(sim.now_us < 12000 + 1000);
+ 
+     /* the retry recovers the bus and resets the sensor first */
+     check_setup(&sim, &dev, SHTC1_MODE_HPM);
+     sim.transport.recover = check_recover;
+     sim.conversion_us[SHTC1_MODE_HPM] = 30000;
+     shtc1_set_timeout(&dev, 12000);
+     policy.max_retries = 1;
+     policy.reset = true;
+     policy.recover_bus = true;
+     shtc1_set_retry_policy(&dev, &policy);
+     recoveries = 0;
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_OK);
+     CHECK(temp == check_temp(CHECK_RAW_T) && rh == check_rh(CHECK_RAW_RH));
+     CHECK(recoveries == 1);
+ #ifdef SHTC1_STATS
+     shtc1_get_stats(&dev, &stats);
+     CHECK(stats.retries == 1);
+     CHECK(stats.resets == 1);
+ #endif
+ }
+ #endif
+ 
+ static void check_sleep(void)
+ {
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     uint8_t i;
+     int temp;
+     int rh;
+ 
+     /* a sleeping sensor only accepts the wakeup command */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     sim.sensors[0].asleep = true;
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) != STATUS_OK);
+ 
+     /* woken up for the measurement and put back to sleep afterwards */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     shtc1_enable_sleep(&dev, true);
+     CHECK(shtc1_sleep(&dev) == STATUS_OK);
+     CHECK(sim.sensors[0].asleep);
+     CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_OK);
+     CHECK(temp == check_temp(CHECK_RAW_T) && rh == check_rh(CHECK_RAW_RH));
+     CHECK(sim.sensors[0].asleep);
+ 
+     /* a wake window keeps the sensor awake across its measurements */
+     CHECK(shtc1_wake_window_begin(&dev) == STATUS_OK);
+     CHECK(!sim.sensors[0].asleep);
+     for (i = 0; i < 3; ++i) {
+         CHECK(shtc1_read_sync(&dev, &temp, &rh) == STATUS_OK);
+         CHECK(!sim.sensors[0].asleep);
+     }
+     CHECK(shtc1_wake_window_end(&dev) == STATUS_OK);
+     CHECK(sim.sensors[0].asleep);
+ }
+ 
+ static void check_continuous(void)
+ {
+     struct shtc1_sample samples[SHTC1_RING_SIZE];
+     struct shtc1_continuous continuous;
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     uint16_t count;
+     uint16_t i;
+ 
+     /* back to back, every expired conversion timer completes a sample */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     pending_count = 0;
+     CHECK(shtc1_continuous_init(&continuous, &dev, check_start_timer) == STATUS_OK);
+     CHECK(shtc1_continuous_start(&continuous, SHTC1_MODE_LPM) == STATUS_OK);
+     CHECK(check_run_timers(10) == 10);
+     count = shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE);
+     CHECK(count == 10);
+     for (i = 0; i < count; ++i) {
+         CHECK(samples[i].status == STATUS_OK);
+         CHECK(samples[i].temp == check_temp(CHECK_RAW_T));
+         CHECK(i == 0 || samples[i].timestamp_us > samples[i - 1].timestamp_us);
+     }
+ 
+     /* a checksum error is stored and sampling continues */
+     sim.sensors[0].corrupt = 1;
+     CHECK(check_run_timers(3) == 3);
+     count = shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE);
+     CHECK(count == 3 && continuous.running);
+     CHECK(samples[0].status == STATUS_ERR_BAD_DATA);
+     CHECK(samples[1].status == STATUS_OK && samples[2].status == STATUS_OK);
+ 
+     /* samples beyond the ring size are dropped, the oldest are kept */
+     CHECK(check_run_timers(SHTC1_RING_SIZE + 4) == SHTC1_RING_SIZE + 4);
+     CHECK(continuous.ring.dropped == 4);
+     CHECK(shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE) == SHTC1_RING_SIZE);
+ 
+     /* the measurement in flight completes, no further one is started */
+     shtc1_continuous_stop(&continuous);
+     check_run_timers(2);
+     CHECK(pending_count == 0 && !shtc1_async_busy(&continuous.async));
+     CHECK(shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE) == 1);
+ 
+     /* a missing sensor stops sampling instead of retriggering at once */
+     sim.sensors[0].present = false;
+     CHECK(shtc1_continuous_start(&continuous, SHTC1_MODE_LPM) == STATUS_OK);
+     check_run_timers(2);
+     CHECK(!continuous.running && pending_count == 0);
+     CHECK(shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE) == 1);
+     CHECK(samples[0].status == STATUS_ERR_BAD_ADDRESS);
+ }
+ 
+ static void check_report_on_change(void)
+ {
+     struct shtc1_sample samples[SHTC1_RING_SIZE];
+     struct shtc1_continuous continuous;
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     /* a signal step of about 1 C and 2 %RH */
+     uint16_t step_t = 375;
+     uint16_t step_rh = 1311;
+ 
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     pending_count = 0;
+     shtc1_continuous_init(&continuous, &dev, check_start_timer);
+     /* 0.5 C, humidity ignored */
+     shtc1_continuous_set_threshold(&continuous, SHTC1_OUTPUT_PER_UNIT / 2, 0);
+     CHECK(shtc1_continuous_start(&continuous, SHTC1_MODE_LPM) == STATUS_OK);
+     CHECK(check_run_timers(5) == 5);
+     CHECK(shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE) == 1);
+     CHECK(continuous.suppressed == 4);
+ 
+     shtc1_sim_set_signals(&sim, 0, CHECK_RAW_T, CHECK_RAW_RH + step_rh);
+     CHECK(check_run_timers(3) == 3);
+     CHECK(shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE) == 0);
+ 
+     shtc1_sim_set_signals(&sim, 0, CHECK_RAW_T + step_t, CHECK_RAW_RH + step_rh);
+     CHECK(check_run_timers(3) == 3);
+     CHECK(shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE) == 1);
+     CHECK(samples[0].temp == check_temp(CHECK_RAW_T + step_t));
+     shtc1_continuous_stop(&continuous);
+     check_run_timers(1);
+ }
+ 
+ static void check_periodic(void)
+ {
+     struct shtc1_sample samples[SHTC1_RING_SIZE];
+     struct shtc1_continuous continuous;
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     uint32_t period_us = 5000;
+     uint32_t start_us;
+     uint16_t count;
+     uint16_t i;
+ 
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     pending_count = 0;
+     shtc1_continuous_init(&continuous, &dev, check_start_timer);
+     /* a period shorter than a measurement is rejected */
+     CHECK(shtc1_continuous_start_periodic(&continuous, SHTC1_MODE_HPM, 10000) ==
+             STATUS_ERR_INVALID_ARG);
+     CHECK(shtc1_continuous_start_periodic(&continuous, SHTC1_MODE_LPM, period_us) ==
+             STATUS_OK);
+ 
+     start_us = sim.now_us;
+     for (i = 0; i < 8; ++i) {
+         sim.now_us = start_us + i * period_us;
+         shtc1_continuous_period_elapsed(&continuous);
+         check_run_timers(1);
+         /* the next measurement is only started by the timer */
+         CHECK(pending_count == 0);
+     }
+     count = shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE);
+     CHECK(count == 8 && continuous.overruns == 0);
+     for (i = 0; i < count; ++i) {
+         CHECK(samples[i].status == STATUS_OK);
+         CHECK(samples[i].timestamp_us == start_us + i * period_us);
+     }
+ 
+     /* a period elapsing during the measurement is reported as an overrun */
+     shtc1_continuous_period_elapsed(&continuous);
+     shtc1_continuous_period_elapsed(&continuous);
+     check_run_timers(1);
+     CHECK(continuous.overruns == 1);
+     count = shtc1_continuous_read(&continuous, samples, SHTC1_RING_SIZE);
+     CHECK(count == 2);
+     CHECK(samples[0].status == STATUS_ERR_OVERFLOW && samples[1].status == STATUS_OK);
+     shtc1_continuous_stop(&continuous);
+ }
+ 
+ static unsigned multibus_cycles;
+ 
+ static void check_multibus_done(struct shtc1_multibus *engine)
+ {
+     (void)engine;
+     ++multibus_cycles;
+ }
+ 
+ static void check_multibus(void)
+ {
+     struct shtc1_sim sims[2];
+     struct shtc1_dev devs[2][3];
+     struct shtc1_sched_result results[2][3];
+     struct shtc1_multibus_bus buses[2];
+     struct shtc1_multibus engine;
+     uint8_t bus;
+     uint8_t i;
+ 
+     for (bus = 0; bus < 2; ++bus) {
+         shtc1_sim_init(&sims[bus], 0x74);
+         for (i = 0; i < 3; ++i)
+             shtc1_init(&devs[bus][i], &sims[bus].transport, 0x74, i);
+     }
+     /* sensor 2 of bus 1 is missing */
+     shtc1_sim_set_signals(&sims[0], 1, CHECK_RAW_T, CHECK_RAW_RH);
+     shtc1_sim_set_signals(&sims[0], 2, CHECK_RAW_T, CHECK_RAW_RH);
+     shtc1_sim_set_signals(&sims[1], 1, CHECK_RAW_T + 1, CHECK_RAW_RH);
+     shtc1_multibus_init_bus(&buses[0], devs[0], results[0], 3);
+     shtc1_multibus_init_bus(&buses[1], devs[1], results[1], 3);
+     shtc1_multibus_init(&engine, buses, 2, check_start_timer, check_multibus_done);
+     pending_count = 0;
+     multibus_cycles = 0;
+ 
+     CHECK(shtc1_multibus_start(&engine, SHTC1_MODE_HPM) == STATUS_OK);
+     /* both buses convert at the same time */
+     CHECK(pending_count == 2);
+     CHECK(shtc1_multibus_start(&engine, SHTC1_MODE_HPM) == STATUS_BUSY);
+     check_run_timers(UINT16_MAX);
+     CHECK(multibus_cycles == 1 && !shtc1_multibus_busy(&engine));
+     for (i = 0; i < 3; ++i) {
+         CHECK(results[0][i].status == STATUS_OK);
+         CHECK(results[0][i].temp == check_temp(CHECK_RAW_T));
+     }
+     CHECK(results[1][0].status == STATUS_OK && results[1][1].status == STATUS_OK);
+     CHECK(results[1][1].temp == check_temp(CHECK_RAW_T + 1));
+     CHECK(results[1][2].status == STATUS_ERR_BAD_ADDRESS);
+     /* three sensors per bus, measured one after the other */
+     CHECK(sims[0].now_us >= 3 * shtc1_get_max_duration_us(SHTC1_MODE_HPM));
+ 
+     CHECK(shtc1_multibus_start(&engine, SHTC1_MODE_LPM) == STATUS_OK);
+     check_run_timers(UINT16_MAX);
+     CHECK(multibus_cycles == 2);
+ }
+ 
+ static bool check_record_equal(const struct shtc1_record *a, const struct shtc1_record *b)
+ {
+     return a->raw_t == b->raw_t && a->raw_rh == b->raw_rh &&
+             a->delta_ms == b->delta_ms && a->flags == b->flags;
+ }
+ 
+ static enum status_code check_record_read(struct shtc1_sim *sim, struct shtc1_dev *dev,
+         uint32_t *reference_us, struct shtc1_record *record)
+ {
+     uint8_t buffer[SHTC1_RECORD_SIZE];
+     enum status_code ret = shtc1_read_async(dev);
+ 
+     if (ret == STATUS_OK)
+         sim->now_us += shtc1_get_max_duration_us(dev->mode);
+     ret = shtc1_read_async_result_record(dev, reference_us, buffer);
+     shtc1_record_unpack(record, buffer);
+     return ret;
+ }
+ 
+ static void check_record(void)
+ {
+     struct shtc1_record record;
+     struct shtc1_record unpacked;
+     struct shtc1_sim sim;
+     struct shtc1_dev dev;
+     uint8_t buffer[SHTC1_RECORD_SIZE];
+     uint32_t reference_us;
+     uint32_t start_us;
+     uint32_t sum_ms = 0;
+     uint16_t i;
+ 
+     record.raw_t = 0x1234;
+     record.raw_rh = 0xfedc;
+     record.delta_ms = 0x8001;
+     record.flags = SHTC1_RECORD_HPM | SHTC1_RECORD_TIME_GAP;
+     shtc1_record_pack(buffer, &record);
+     shtc1_record_unpack(&unpacked, buffer);
+     CHECK(check_record_equal(&record, &unpacked));
+ 
+     check_setup(&sim, &dev, SHTC1_MODE_HPM);
+     reference_us = sim.now_us;
+     CHECK(check_record_read(&sim, &dev, &reference_us, &record) == STATUS_OK);
+     CHECK(record.raw_t == CHECK_RAW_T && record.raw_rh == CHECK_RAW_RH);
+     CHECK(record.flags == SHTC1_RECORD_HPM && record.delta_ms == 0);
+ 
+     /* deltas of 1.5 ms sum up without losing the remainders */
+     check_setup(&sim, &dev, SHTC1_MODE_LPM);
+     shtc1_set_bus_speed(&dev, SHTC1_SPEED_FAST_PLUS);
+     start_us = sim.now_us;
+     reference_us = start_us;
+     for (i = 0; i < 1000; ++i) {
+         sim.now_us = start_us + i * 1500;
+         CHECK(check_record_read(&sim, &dev, &reference_us, &record) == STATUS_OK);
+         sum_ms += record.delta_ms;
+     }
+     CHECK(record.flags == 0);
+     CHECK(sum_ms == 999 * 1500 / 1000);
+ 
+     /* a gap beyond the delta range saturates and is flagged */
+     reference_us = sim.now_us - 70000000;
+     CHECK(check_record_read(&sim, &dev, &reference_us, &record) == STATUS_OK);
+     CHECK(record.delta_ms == UINT16_MAX && (record.flags & SHTC1_RECORD_TIME_GAP));
+ 
+     sim.sensors[0].corrupt = 1;
+     CHECK(check_record_read(&sim, &dev, &reference_us, &record) == STATUS_ERR_BAD_DATA);
+     CHECK(record.flags & SHTC1_RECORD_BAD_DATA);
+     sim.sensors[0].present = false;
+     CHECK(check_record_read(&sim, &dev, &reference_us, &record) != STATUS_OK);
+     CHECK(record.flags & SHTC1_RECORD_BUS_ERROR);
+ }
+ 
+ static void check_codec(void)
+ {
+     static const uint32_t values[] = { 0, 1, 127, 128, 16383, 16384, 0x1fffff };
+     struct shtc1_encoder encoder;
+     struct shtc1_decoder decoder;
+     uint8_t buffer[64 * SHTC1_CODEC_MAX_SIZE];
+     uint16_t raw_t[64];
+     uint16_t raw_rh[64];
+     uint16_t out_t;
+     uint16_t out_rh;
+     uint32_t value;
+     uint16_t used = 0;
+     uint16_t offset = 0;
+     uint8_t length;
+     size_t i;
+ 
+     CHECK(shtc1_zigzag(0) == 0 && shtc1_zigzag(-1) == 1 && shtc1_zigzag(1) == 2);
+     CHECK(shtc1_unzigzag(shtc1_zigzag(-12345)) == -12345);
+     for (i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+         length = shtc1_varint_put(buffer, values[i]);
+         CHECK(length >= 1 && length <= SHTC1_VARINT_MAX_SIZE);
+         CHECK(shtc1_varint_get(buffer, length, &value) == length && value == values[i]);
+         CHECK(shtc1_varint_get(buffer, length - 1, &value) == 0);
+     }
+ 
+     /* slow drifts with a few steps, with a keyframe every 16 samples */
+     for (i = 0; i < 64; ++i) {
+         raw_t[i] = (uint16_t)(CHECK_RAW_T + i * 3 - (i % 5) + (i == 40 ? 20000 : 0));
+         raw_rh[i] = (uint16_t)(CHECK_RAW_RH - i * 7 + (i % 3));
+     }
+     shtc1_encoder_init(&encoder, 16);
+     for (i = 0; i < 64; ++i)
+         used += shtc1_encode(&encoder, raw_t[i], raw_rh[i], &buffer[used]);
+     /* most differences fit a byte per signal */
+     CHECK(used < 64 * 3);
+ 
+     shtc1_decoder_init(&decoder);
+     for (i = 0; i < 64; ++i) {
+         length = shtc1_decode(&decoder, &buffer[offset], used - offset, &out_t, &out_rh);
+         CHECK(length > 0 && out_t == raw_t[i] && out_rh == raw_rh[i]);
+         if (!length)
+             break;
+         offset += length;
+     }
+     CHECK(offset == used);
+ 
+     /* a difference without a preceding keyframe is rejected */
+     shtc1_encoder_init(&encoder, 0);
+     shtc1_encode(&encoder, raw_t[0], raw_rh[0], buffer);
+     length = shtc1_encode(&encoder, raw_t[1], raw_rh[1], buffer);
+     shtc1_decoder_init(&decoder);
+     CHECK(shtc1_decode(&decoder, buffer, length, &out_t, &out_rh) == 0);
+ }
+ 
+ struct check_flash {
+     struct shtc1_log_flash flash;
+     uint8_t pages[CHECK_LOG_PAGES][SHTC1_LOG_PAGE_SIZE];
+     /** number of following page writes that fail */
+     uint8_t failing_writes;
+ };
+ 
+ static enum status_code check_write_page(struct shtc1_log_flash *flash, uint32_t page,
+         const uint8_t *data)
+ {
+     struct check_flash *ram = (struct check_flash *)flash;
+ 
+     if (ram->failing_writes) {
+         --ram->failing_writes;
+         return STATUS_ERR_IO;
+     }
+     memcpy(ram->pages[page], data, SHTC1_LOG_PAGE_SIZE);
+     return STATUS_OK;
+ }
+ 
+ static enum status_code check_read_page(struct shtc1_log_flash *flash, uint32_t page,
+         uint8_t *data)
+ {
+     memcpy(data, ((struct check_flash *)flash)->pages[page], SHTC1_LOG_PAGE_SIZE);
+     return STATUS_OK;
+ }
+ 
+ static void check_log_record(struct shtc1_record *record, uint16_t n)
+ {
+     record->raw_t = (uint16_t)(CHECK_RAW_T + n * 5);
+     record->raw_rh = (uint16_t)(CHECK_RAW_RH - n * 3);
+     record->delta_ms = (uint16_t)(1000 + n % 7);
+     record->flags = n % 50 ? 0 : SHTC1_RECORD_BAD_DATA;
+ }
+ 
+ /* reads the whole log back and returns the samples, from first on */
+ static uint16_t check_log_read_back(const struct shtc1_log *log, uint16_t first)
+ {
+     struct shtc1_log_reader reader;
+     struct shtc1_record expected;
+     struct shtc1_record record;
+     uint16_t n = 0;
+ 
+     shtc1_log_reader_init(&reader, log);
+     while (shtc1_log_read(&reader, &record) == STATUS_OK) {
+         check_log_record(&expected, first + n);
+         CHECK(check_record_equal(&record, &expected));
+         ++n;
+     }
+     return n;
+ }
+ 
+ static void check_log(void)
+ {
+     struct check_flash ram;
+     struct shtc1_log log;
+     struct shtc1_log_reader reader;
+     struct shtc1_record record;
+     uint16_t total = 0;
+     uint16_t per_page;
+     uint16_t first;
+ 
+     memset(&ram, 0xff, sizeof(ram));
+     ram.flash.write_page = check_write_page;
+     ram.flash.read_page = check_read_page;
+     ram.flash.page_count = CHECK_LOG_PAGES;
+     ram.failing_writes = 0;
+     CHECK(shtc1_log_init(&log, &ram.flash) == STATUS_OK);
+     CHECK(check_log_read_back(&log, 0) == 0);
+ 
+     /* fill two pages, samples not yet flushed are not read back */
+     while (log.next_page < 2) {
+         check_log_record(&record, total);
+         CHECK(shtc1_log_append(&log, &record) == STATUS_OK);
+         ++total;
+     }
+     per_page = (total - log.count) / 2;
+     /* denser than packed records */
+     CHECK(per_page * SHTC1_RECORD_SIZE > SHTC1_LOG_PAGE_SIZE);
+     CHECK(check_log_read_back(&log, 0) == total - log.count);
+     CHECK(shtc1_log_flush(&log) == STATUS_OK);
+     CHECK(check_log_read_back(&log, 0) == total);
+ 
+     /* a failed page write keeps the page, appending again retries it */
+     do {
+         check_log_record(&record, total);
+         ram.failing_writes = 1;
+         if (shtc1_log_append(&log, &record) == STATUS_OK) {
+             ++total;
+             continue;
+         }
+         CHECK(shtc1_log_append(&log, &record) == STATUS_OK);
+         ++total;
+         break;
+     } while (total < 4 * SHTC1_LOG_PAGE_SIZE);
+     ram.failing_writes = 0;
+     CHECK(shtc1_log_flush(&log) == STATUS_OK);
+     CHECK(check_log_read_back(&log, 0) == total);
+ 
+     /* a log opened on the same flash continues after the newest page */
+     CHECK(shtc1_log_init(&log, &ram.flash) == STATUS_OK);
+     CHECK(check_log_read_back(&log, 0) == total);
+     while (log.sequence < CHECK_LOG_PAGES + 2) {
+         check_log_record(&record, total);
+         CHECK(shtc1_log_append(&log, &record) == STATUS_OK);
+         ++total;
+     }
+     CHECK(shtc1_log_flush(&log) == STATUS_OK);
+ 
+     /* the area has wrapped, reading starts at the oldest page left */
+     shtc1_log_reader_init(&reader, &log);
+     CHECK(shtc1_log_read(&reader, &record) == STATUS_OK);
+     first = (uint16_t)(record.raw_t - CHECK_RAW_T) / 5;
+     CHECK(first > 0);
+     CHECK(check_log_read_back(&log, first) == total - first);
+ }
+ 
+ static void check_filter(void)
+ {
+     struct shtc1_boxcar boxcar;
+     struct shtc1_ema ema;
+     struct shtc1_window window;
+     struct shtc1_summary summary;
+     uint16_t out_t;
+     uint16_t out_rh;
+     uint16_t i;
+ 
+     shtc1_boxcar_init(&boxcar, 4);
+     CHECK(!shtc1_boxcar_push(&boxcar, 100, 1000, &out_t, &out_rh));
+     CHECK(!shtc1_boxcar_push(&boxcar, 200, 2000, &out_t, &out_rh));
+     CHECK(!shtc1_boxcar_push(&boxcar, 300, 3000, &out_t, &out_rh));
+     CHECK(shtc1_boxcar_push(&boxcar, 400, 4000, &out_t, &out_rh));
+     CHECK(out_t == 250 && out_rh == 2500);
+     CHECK(!shtc1_boxcar_push(&boxcar, 100, 1000, &out_t, &out_rh));
+ 
+     /* the first sample primes the filter, a step settles towards the input */
+     shtc1_ema_init(&ema, 3);
+     shtc1_ema_push(&ema, 1000, 50000, &out_t, &out_rh);
+     CHECK(out_t == 1000 && out_rh == 50000);
+     for (i = 0; i < 8; ++i)
+         shtc1_ema_push(&ema, 2000, 40000, &out_t, &out_rh);
+     CHECK(out_t > 1500 && out_t < 2000 && out_rh < 45000 && out_rh > 40000);
+     for (i = 0; i < 200; ++i)
+         shtc1_ema_push(&ema, 2000, 40000, &out_t, &out_rh);
+     CHECK(out_t >= 1999 && out_t <= 2000 && out_rh >= 40000 && out_rh <= 40001);
+ 
+     shtc1_window_init(&window, 3);
+     CHECK(!shtc1_window_push(&window, 500, 7, &summary));
+     CHECK(!shtc1_window_push(&window, 900, 3, &summary));
+     CHECK(shtc1_window_push(&window, 100, 5, &summary));
+     CHECK(summary.min_t == 100 && summary.max_t == 900 && summary.mean_t == 500);
+     CHECK(summary.min_rh == 3 && summary.max_rh == 7 && summary.mean_rh == 5);
+ }
+ 
+ static bool check_near(int32_t value, int32_t expected, int32_t tolerance)
+ {
+     return value >= expected - tolerance && value <= expected + tolerance;
+ }
+ 
+ static void check_derived(void)
+ {
+     /* reference values of the floating point formulas */
+     CHECK(check_near(shtc1_dew_point(25000, 50000), 13851, 50));
+     CHECK(check_near(shtc1_dew_point(10000, 90000), 8434, 50));
+     CHECK(check_near(shtc1_absolute_humidity(25000, 50000), 11484, 100));
+     CHECK(check_near(shtc1_heat_index(20000, 50000), 19361, 300));
+     CHECK(check_near(shtc1_heat_index(32000, 70000), 40409, 300));
+ }
+ 
+ int main(void)
+ {
+     check_sync();
+     check_poll();
+     check_probe();
+     check_retry();
+ #ifdef SHTC1_CLOCK_STRETCHING
+     check_timeout();
+ #endif
+     check_sleep();
+     check_continuous();
+     check_report_on_change();
+     check_periodic();
+     check_multibus();
+     check_record();
+     check_codec();
+     check_log();
+     check_filter();
+     check_derived();
+ 
+ #ifdef SHTC1_CLOCK_STRETCHING
+     printf("clock stretching: ");
+ #endif
+     printf("%u checks, %u failed\n", checks, failures);
+     return failures ? 1 : 0;
+ }
\ No newline at end of file
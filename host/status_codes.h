@@ -0,0 +1,49 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Status codes for host builds
+ *
+ * The driver reports errors with the status codes of the Atmel Software
+ * Framework. This header provides the subset the driver uses, with the values
+ * of the ASF status_codes.h, for builds without ASF.
+ */
+
+ #ifndef STATUS_CODES_H_INCLUDED
+ #define STATUS_CODES_H_INCLUDED
+ 
+ enum status_code {
+     STATUS_OK                         = 0x00,
+     STATUS_BUSY                       = 0x05,
+     STATUS_ERR_IO                     = 0x10,
+     STATUS_ERR_TIMEOUT                = 0x12,
+     STATUS_ERR_BAD_DATA               = 0x13,
+     STATUS_ERR_NOT_FOUND              = 0x14,
+     STATUS_ERR_UNSUPPORTED_DEV        = 0x15,
+     STATUS_ERR_NO_MEMORY              = 0x16,
+     STATUS_ERR_INVALID_ARG            = 0x17,
+     STATUS_ERR_BAD_ADDRESS            = 0x18,
+     STATUS_ERR_BAD_FORMAT             = 0x1a,
+     STATUS_ERR_DENIED                 = 0x1c,
+     STATUS_ERR_OVERFLOW               = 0x1e,
+     STATUS_ERR_NOT_INITIALIZED        = 0x1f,
+     STATUS_ERR_BAUDRATE_UNAVAILABLE   = 0x22,
+     STATUS_ERR_PACKET_COLLISION       = 0x23,
+ };
+ 
+ #endif /* STATUS_CODES_H_INCLUDED */
\ No newline at end of file
@@ -33,14 +33,18 @@
  *
  * \brief Sensirion SHTC1 driver implementation
  *
- * This module provides access to the SHTC1 functionality over the ASF I2C
- * interface. It allows measurements in normal and clock stretching
+ * This module provides access to the SHTC1 functionality over an I2C
+ * transport, see shtc1_transport.h and the ASF implementation in shtc1_asf.h.
+ * It allows measurements in normal and clock stretching
  * mode as well as executing a soft reset command.
  */
 
- #include <asf.h>
+ #include <string.h>
+ #if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+ #include <arm_acle.h>
+ #endif
  #include "shtc1.h"
- #include "i2c_master.h"
+ #include "shtc1_internal.h"
  
  /* all measurement commands return T (CRC) RH (CRC) */
  const uint8_t CMD_MEASURE_LPM_CS[]  = { 0x64, 0x58 };
@@ -49,6 +53,9 @@
  const uint8_t CMD_MEASURE_HPM[]     = { 0x78, 0x66 };
  const uint8_t CMD_SOFT_RESET[]      = { 0x80, 0x5d };
  const uint8_t CMD_READ_ID_REG[]     = { 0xef, 0xc8 };
+ /* SHTC3 command set */
+ const uint8_t CMD_SLEEP[]           = { 0xb0, 0x98 };
+ const uint8_t CMD_WAKEUP[]          = { 0x35, 0x17 };
  const size_t COMMAND_SIZE = sizeof(CMD_MEASURE_LPM);
  const uint16_t SHTC1_ADDRESS    = 0x70;
  
@@ -57,151 +64,747 @@
  const uint8_t CRC_POLYNOMIAL    = 0x31;
  const uint8_t CRC_INIT          = 0xff;
  
- static bool shtc1_check_crc(uint8_t *data, uint8_t data_length, uint8_t checksum)
+ const uint8_t *const CMD_MEASURE[] = {
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_LPM
+     [SHTC1_MODE_LPM] = CMD_MEASURE_LPM,
+ #endif
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_HPM
+     [SHTC1_MODE_HPM] = CMD_MEASURE_HPM,
+ #endif
+ };
+ 
+ #if SHTC1_CONFIG_SYNC && defined(SHTC1_CLOCK_STRETCHING)
+ /* clock stretching measurement commands, indexed by enum shtc1_mode */
+ static const uint8_t *const CMD_MEASURE_CS[] = {
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_LPM
+     [SHTC1_MODE_LPM] = CMD_MEASURE_LPM_CS,
+ #endif
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_HPM
+     [SHTC1_MODE_HPM] = CMD_MEASURE_HPM_CS,
+ #endif
+ };
+ #endif
+ 
+ /* maximum conversion times according to the SHTC1 datasheet in microseconds */
+ static const uint16_t MEASUREMENT_DURATION_US[] = {
+     [SHTC1_MODE_LPM] = 940,
+     [SHTC1_MODE_HPM] = 14400,
+ };
+ 
+ #if SHTC1_CONFIG_ASYNC
+ /* interval between two readout attempts of shtc1_poll_result() in microseconds */
+ static const uint16_t POLL_BACKOFF_US[] = {
+     [SHTC1_MODE_LPM] = 100,
+     [SHTC1_MODE_HPM] = 500,
+ };
+ #endif
+ 
+ #if SHTC1_CONFIG_SYNC
+ /* upper bound of the doubled retry backoff of shtc1_read_sync() in microseconds */
+ static const uint32_t MAX_BACKOFF_US = 100000;
+ #endif
+ 
+ /* maximum duration of a soft reset in microseconds */
+ const uint16_t SOFT_RESET_DURATION_US = 240;
+ 
+ /* maximum time from the wakeup command until the sensor accepts commands in microseconds */
+ static const uint16_t WAKEUP_DURATION_US = 240;
+ 
+ #if SHTC1_CRC_BACKEND == SHTC1_CRC_TABLE
+ /* CRC_POLYNOMIAL applied to every possible byte value */
+ static const uint8_t CRC_TABLE[256] = {
+         0x00, 0x31, 0x62, 0x53, 0xc4, 0xf5, 0xa6, 0x97,
+         0xb9, 0x88, 0xdb, 0xea, 0x7d, 0x4c, 0x1f, 0x2e,
+         0x43, 0x72, 0x21, 0x10, 0x87, 0xb6, 0xe5, 0xd4,
+         0xfa, 0xcb, 0x98, 0xa9, 0x3e, 0x0f, 0x5c, 0x6d,
+         0x86, 0xb7, 0xe4, 0xd5, 0x42, 0x73, 0x20, 0x11,
+         0x3f, 0x0e, 0x5d, 0x6c, 0xfb, 0xca, 0x99, 0xa8,
+         0xc5, 0xf4, 0xa7, 0x96, 0x01, 0x30, 0x63, 0x52,
+         0x7c, 0x4d, 0x1e, 0x2f, 0xb8, 0x89, 0xda, 0xeb,
+         0x3d, 0x0c, 0x5f, 0x6e, 0xf9, 0xc8, 0x9b, 0xaa,
+         0x84, 0xb5, 0xe6, 0xd7, 0x40, 0x71, 0x22, 0x13,
+         0x7e, 0x4f, 0x1c, 0x2d, 0xba, 0x8b, 0xd8, 0xe9,
+         0xc7, 0xf6, 0xa5, 0x94, 0x03, 0x32, 0x61, 0x50,
+         0xbb, 0x8a, 0xd9, 0xe8, 0x7f, 0x4e, 0x1d, 0x2c,
+         0x02, 0x33, 0x60, 0x51, 0xc6, 0xf7, 0xa4, 0x95,
+         0xf8, 0xc9, 0x9a, 0xab, 0x3c, 0x0d, 0x5e, 0x6f,
+         0x41, 0x70, 0x23, 0x12, 0x85, 0xb4, 0xe7, 0xd6,
+         0x7a, 0x4b, 0x18, 0x29, 0xbe, 0x8f, 0xdc, 0xed,
+         0xc3, 0xf2, 0xa1, 0x90, 0x07, 0x36, 0x65, 0x54,
+         0x39, 0x08, 0x5b, 0x6a, 0xfd, 0xcc, 0x9f, 0xae,
+         0x80, 0xb1, 0xe2, 0xd3, 0x44, 0x75, 0x26, 0x17,
+         0xfc, 0xcd, 0x9e, 0xaf, 0x38, 0x09, 0x5a, 0x6b,
+         0x45, 0x74, 0x27, 0x16, 0x81, 0xb0, 0xe3, 0xd2,
+         0xbf, 0x8e, 0xdd, 0xec, 0x7b, 0x4a, 0x19, 0x28,
+         0x06, 0x37, 0x64, 0x55, 0xc2, 0xf3, 0xa0, 0x91,
+         0x47, 0x76, 0x25, 0x14, 0x83, 0xb2, 0xe1, 0xd0,
+         0xfe, 0xcf, 0x9c, 0xad, 0x3a, 0x0b, 0x58, 0x69,
+         0x04, 0x35, 0x66, 0x57, 0xc0, 0xf1, 0xa2, 0x93,
+         0xbd, 0x8c, 0xdf, 0xee, 0x79, 0x48, 0x1b, 0x2a,
+         0xc1, 0xf0, 0xa3, 0x92, 0x05, 0x34, 0x67, 0x56,
+         0x78, 0x49, 0x1a, 0x2b, 0xbc, 0x8d, 0xde, 0xef,
+         0x82, 0xb3, 0xe0, 0xd1, 0x46, 0x77, 0x24, 0x15,
+         0x3b, 0x0a, 0x59, 0x68, 0xff, 0xce, 0x9d, 0xac
+ };
+ #elif SHTC1_CRC_BACKEND == SHTC1_CRC_NIBBLE
+ /* CRC_POLYNOMIAL applied to every possible upper nibble */
+ static const uint8_t CRC_TABLE[16] = {
+         0x00, 0x31, 0x62, 0x53, 0xc4, 0xf5, 0xa6, 0x97,
+         0xb9, 0x88, 0xdb, 0xea, 0x7d, 0x4c, 0x1f, 0x2e
+ };
+ #endif
+ 
+ static inline uint8_t shtc1_crc8_update(uint8_t crc, uint8_t data)
+ {
+ #if SHTC1_CRC_BACKEND == SHTC1_CRC_TABLE
+     return CRC_TABLE[crc ^ data];
+ #elif SHTC1_CRC_BACKEND == SHTC1_CRC_NIBBLE
+     crc ^= data;
+     crc = (uint8_t)(crc << 4) ^ CRC_TABLE[crc >> 4];
+     return (uint8_t)(crc << 4) ^ CRC_TABLE[crc >> 4];
+ #else
+     crc ^= data;
+     for (uint8_t bit = 8; bit > 0; --bit)
+     {
+         if (crc & 0x80)
+             crc = (crc << 1) ^ CRC_POLYNOMIAL;
+         else
+             crc = (crc << 1);
+     }
+     return crc;
+ #endif
+ }
+ 
+ uint8_t shtc1_crc8(const uint8_t *data, uint8_t data_length)
  {
      uint8_t crc = CRC_INIT;
      uint8_t current_byte;
  
      /* calculates 8-Bit checksum with given polynomial */
      for (current_byte = 0; current_byte < data_length; ++current_byte)
-     {
-         crc ^= (data[current_byte]);
-         for (uint8_t bit = 8; bit > 0; --bit)
-         {
-             if (crc & 0x80)
-                 crc = (crc << 1) ^ CRC_POLYNOMIAL;
-             else
-                 crc = (crc << 1);
-         }
-     }
-     return crc == checksum;
+         crc = shtc1_crc8_update(crc, data[current_byte]);
+     return crc;
  }
  
- enum status_code shtc1_read_async_result(struct i2c_master_module *i2c_master_instance_ptr,
-         int *temp, int *rh)
+ bool shtc1_check_frame(const uint8_t *frame)
  {
-     uint8_t data[6];
-     struct i2c_master_packet packet = {
-             .address = SHTC1_ADDRESS,
-             .data_length = sizeof(data),
-             .data = data,
-             .ten_bit_address = false,
-             .high_speed = false,
-     };
-     enum status_code ret = i2c_master_read_packet_wait(i2c_master_instance_ptr, &packet);
-     //print_to_terminal("ret in  shtc1_read_async_result = 0x%x\n", ret);
-     
-     if (ret)
-         return ret;
-     if (!shtc1_check_crc(data, 2, data[2]) || !shtc1_check_crc(data + 3, 2, data[5]))
-         return STATUS_ERR_BAD_DATA;
+     /* both words are checked independently, the loop is unrolled on purpose */
+     uint8_t crc_t = shtc1_crc8_update(shtc1_crc8_update(CRC_INIT, frame[0]), frame[1]);
+     uint8_t crc_rh = shtc1_crc8_update(shtc1_crc8_update(CRC_INIT, frame[3]), frame[4]);
+ 
+     return crc_t == frame[2] && crc_rh == frame[5];
+ }
  
+ void shtc1_convert_frame(const uint8_t *frame, int *temp, int *rh)
+ {
      /**
       * formulas for conversion of the sensor signals, optimized for fixed point
       * algebra:
       * T = 175 * S_T / 2^16 - 45
       * RH = 100 * S_RH / 2^16
       */
-     *temp = (data[1] & 0xff) | (data[0] << 8);
-     *rh = (data[4] & 0xff) | (data[3] << 8);
-     *temp = ((21875 * *temp) >> 13) - 45000;
-     *rh = ((12500 * *rh) >> 13);
+ #if SHTC1_OUTPUT_FORMAT == SHTC1_OUTPUT_CENTI
+     *temp = shtc1_raw_to_centi_temp(shtc1_frame_raw_t(frame));
+     *rh = shtc1_raw_to_centi_rh(shtc1_frame_raw_rh(frame));
+ #else
+     *temp = shtc1_raw_to_milli_temp(shtc1_frame_raw_t(frame));
+     *rh = shtc1_raw_to_milli_rh(shtc1_frame_raw_rh(frame));
+ #endif
+ }
  
-     return STATUS_OK;
+ void shtc1_convert_batch(const uint16_t *restrict raw_t, const uint16_t *restrict raw_rh,
+         int32_t *restrict temp, int32_t *restrict rh, size_t count)
+ {
+     size_t i = 0;
+ 
+ #if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+     /**
+      * Two samples per word: biasing the signals by -2^15 makes them fit the
+      * signed halfword multiplies, the bias is a multiple of 2^13 after the
+      * scaling and folds into the offsets:
+      * (21875 * (S - 2^15)) >> 13 + 87500 - 45000
+      * (12500 * (S - 2^15)) >> 13 + 50000
+      */
+     for (; i + 2 <= count; i += 2) {
+         uint32_t words_t, words_rh;
+ 
+         memcpy(&words_t, &raw_t[i], sizeof(words_t));
+         memcpy(&words_rh, &raw_rh[i], sizeof(words_rh));
+         words_t ^= 0x80008000;
+         words_rh ^= 0x80008000;
+         temp[i] = (__smulbb(words_t, 21875) >> 13) + 42500;
+         temp[i + 1] = (__smultb(words_t, 21875) >> 13) + 42500;
+         rh[i] = (__smulbb(words_rh, 12500) >> 13) + 50000;
+         rh[i + 1] = (__smultb(words_rh, 12500) >> 13) + 50000;
+     }
+ #endif
+ 
+     for (; i < count; ++i) {
+         temp[i] = shtc1_raw_to_milli_temp(raw_t[i]);
+         rh[i] = shtc1_raw_to_milli_rh(raw_rh[i]);
+     }
  }
  
- static enum status_code shtc1_read_sync(struct i2c_master_module *i2c_master_instance_ptr,
-         const uint8_t command[], int *temp, int *rh)
+ void shtc1_init(struct shtc1_dev *dev, struct shtc1_transport *transport,
+         uint8_t mux_address, uint8_t mux_channel)
  {
-     enum status_code ret;
-     struct i2c_master_packet packet = {
-             .address = SHTC1_ADDRESS,
-             .data_length = COMMAND_SIZE,
-             .data = (uint8_t *)command,
-             .ten_bit_address = false,
-             .high_speed = false,
+     dev->transport = transport;
+     dev->mux_address = mux_address;
+     dev->mux_mask = 1 << mux_channel;
+     dev->mode = SHTC1_MODE_HPM;
+     dev->last_start_us = 0;
+     dev->xfer.address = SHTC1_ADDRESS;
+     dev->xfer.flags = 0;
+     dev->xfer.speed_khz = 0;
+     dev->xfer.timeout_us = 0;
+     dev->retry.max_retries = 0;
+     dev->retry.backoff_us = 0;
+     dev->retry.reset = false;
+     dev->retry.recover_bus = false;
+     dev->sleep_supported = false;
+     dev->auto_sleep = false;
+     dev->power_state = SHTC1_POWER_AWAKE;
+     dev->wake_holds = 0;
+     dev->xfer.length = 0;
+     dev->xfer.data = dev->buffer;
+ #ifdef SHTC1_STATS
+     shtc1_clear_stats(dev);
+ #endif
+ }
+ 
+ void shtc1_set_bus_speed(struct shtc1_dev *dev, uint16_t speed_khz)
+ {
+     dev->xfer.speed_khz = speed_khz;
+ }
+ 
+ void shtc1_set_timeout(struct shtc1_dev *dev, uint16_t timeout_us)
+ {
+     dev->xfer.timeout_us = timeout_us;
+ }
+ 
+ void shtc1_set_retry_policy(struct shtc1_dev *dev, const struct shtc1_retry_policy *policy)
+ {
+     dev->retry = *policy;
+ }
+ 
+ uint32_t shtc1_get_bus_time_us(const struct shtc1_dev *dev)
+ {
+     /* start, 9 clocks per byte including the acknowledge, stop */
+     uint32_t bits = (1 + 9 * (1 + COMMAND_SIZE) + 1) + (1 + 9 * (1 + SHTC1_FRAME_SIZE) + 1);
+     uint32_t speed_khz = dev->xfer.speed_khz ? dev->xfer.speed_khz : SHTC1_SPEED_STANDARD;
+     uint32_t time_us;
+ 
+     time_us = (bits * 1000 + speed_khz - 1) / speed_khz;
+     /* the multiplexer runs at the speed of the bus, assume standard mode */
+     if (dev->mux_address != SHTC1_NO_MUX)
+         time_us += 2 * (1 + 9 * 2 + 1) * 1000 / SHTC1_SPEED_STANDARD;
+     return time_us;
+ }
+ 
+ uint16_t shtc1_get_max_sensors_per_bus(const struct shtc1_dev *dev, uint16_t sample_rate_hz)
+ {
+     uint32_t bus_time_us = shtc1_get_bus_time_us(dev);
+     uint32_t sensors;
+ 
+     if (!sample_rate_hz)
+         return UINT16_MAX;
+     /* one sensor can not be measured faster than conversion plus transfers */
+     if ((MEASUREMENT_DURATION_US[shtc1_effective_mode(dev->mode)] + bus_time_us) * sample_rate_hz > 1000000)
+         return 0;
+ 
+     sensors = 1000000 / (bus_time_us * sample_rate_hz);
+     return sensors > UINT16_MAX ? UINT16_MAX : (uint16_t)sensors;
+ }
+ 
+ uint32_t shtc1_get_timestamp_us(const struct shtc1_dev *dev)
+ {
+     if (!dev->transport->timestamp_us)
+         return 0;
+     return dev->transport->timestamp_us(dev->transport);
+ }
+ 
+ uint16_t shtc1_get_max_duration_us(enum shtc1_mode mode)
+ {
+     return MEASUREMENT_DURATION_US[shtc1_effective_mode(mode)];
+ }
+ 
+ #ifdef SHTC1_STATS
+ static enum status_code shtc1_count_xfer(struct shtc1_dev *dev, enum status_code ret)
+ {
+     ++dev->stats.transactions;
+     if (ret == STATUS_ERR_BAD_ADDRESS)
+         ++dev->stats.nacks;
+     return ret;
+ }
+ 
+ static inline void shtc1_count_latency(struct shtc1_dev *dev)
+ {
+     uint32_t latency_ms;
+     uint8_t bucket = 0;
+ 
+     if (!dev->transport->timestamp_us)
+         return;
+     latency_ms = (shtc1_get_timestamp_us(dev) - dev->last_start_us) / 1000;
+     while (latency_ms && bucket < SHTC1_STATS_BUCKETS - 1) {
+         latency_ms >>= 1;
+         ++bucket;
+     }
+     ++dev->stats.latency[bucket];
+ }
+ 
+ #define SHTC1_COUNT(dev, counter) (++(dev)->stats.counter)
+ #define SHTC1_COUNT_XFER(dev, ret) shtc1_count_xfer(dev, ret)
+ #define SHTC1_COUNT_LATENCY(dev) shtc1_count_latency(dev)
+ 
+ void shtc1_get_stats(const struct shtc1_dev *dev, struct shtc1_stats *stats)
+ {
+     *stats = dev->stats;
+ }
+ 
+ void shtc1_clear_stats(struct shtc1_dev *dev)
+ {
+     memset(&dev->stats, 0, sizeof(dev->stats));
+ }
+ #else
+ #define SHTC1_COUNT(dev, counter) ((void)0)
+ #define SHTC1_COUNT_XFER(dev, ret) (ret)
+ #define SHTC1_COUNT_LATENCY(dev) ((void)0)
+ #endif
+ 
+ /* takes the bus for a sequence of transfers if other tasks share it */
+ static enum status_code shtc1_lock(struct shtc1_dev *dev)
+ {
+     if (!dev->transport->lock)
+         return STATUS_OK;
+     return dev->transport->lock(dev->transport);
+ }
+ 
+ static void shtc1_unlock(struct shtc1_dev *dev)
+ {
+     if (dev->transport->unlock)
+         dev->transport->unlock(dev->transport);
+ }
+ 
+ static enum status_code shtc1_select(struct shtc1_dev *dev)
+ {
+     struct shtc1_xfer xfer = {
+             .address = dev->mux_address,
+             .flags = 0,
+             .speed_khz = 0,
+             .timeout_us = 0,
+             .length = sizeof(dev->mux_mask),
+             .data = &dev->mux_mask,
      };
-     ret = i2c_master_write_packet_wait_no_stop(i2c_master_instance_ptr, &packet);
-     //print_to_terminal("ret in  shtc1_read_sync = 0x%x\n", ret);
-     delay_ms(50);
-     
+ 
+     if (dev->mux_address == SHTC1_NO_MUX)
+         return STATUS_OK;
+     return SHTC1_COUNT_XFER(dev, SHTC1_TRANSPORT_WRITE(dev->transport, &xfer));
+ }
+ 
+ static enum status_code shtc1_write_command(struct shtc1_dev *dev, const uint8_t *command,
+         bool stop)
+ {
+     enum status_code ret = shtc1_select(dev);
+ 
      if (ret)
          return ret;
-     return shtc1_read_async_result(i2c_master_instance_ptr, temp, rh);
+ 
+     dev->xfer.flags = stop ? 0 : SHTC1_XFER_NO_STOP;
+     dev->xfer.length = COMMAND_SIZE;
+     dev->xfer.data = (uint8_t *)command;
+     return SHTC1_COUNT_XFER(dev, SHTC1_TRANSPORT_WRITE(dev->transport, &dev->xfer));
  }
  
- enum status_code shtc1_read_lpm_sync(struct i2c_master_module *i2c_master_instance_ptr,
-         int *temp, int *rh)
+ /* writes a command followed by a stop condition as one locked transaction */
+ static enum status_code shtc1_send_command(struct shtc1_dev *dev, const uint8_t *command)
  {
-     return shtc1_read_sync(i2c_master_instance_ptr, CMD_MEASURE_LPM_CS, temp, rh);
+     enum status_code ret = shtc1_lock(dev);
+ 
+     if (ret)
+         return ret;
+     ret = shtc1_write_command(dev, command, true);
+     shtc1_unlock(dev);
+     return ret;
  }
  
- enum status_code shtc1_read_hpm_sync(struct i2c_master_module *i2c_master_instance_ptr,
-         int *temp, int *rh)
+ /* reads length bytes into the buffer of the device */
+ static enum status_code shtc1_read_buffer(struct shtc1_dev *dev, uint16_t length)
  {
-     return shtc1_read_sync(i2c_master_instance_ptr, CMD_MEASURE_HPM_CS, temp, rh);
+     dev->xfer.flags = 0;
+     dev->xfer.length = length;
+     dev->xfer.data = dev->buffer;
+     return SHTC1_COUNT_XFER(dev, SHTC1_TRANSPORT_READ(dev->transport, &dev->xfer));
  }
  
- enum status_code shtc1_read_lpm_async(struct i2c_master_module *i2c_master_instance_ptr)
+ /**
+  * writes a command, then reads length bytes into the buffer with a repeated
+  * start, as a single transaction if the transport supports it. The bus is
+  * locked for the whole sequence.
+  */
+ static enum status_code shtc1_command_read(struct shtc1_dev *dev, const uint8_t *command,
+         uint16_t length)
  {
-     struct i2c_master_packet packet = {
+     struct shtc1_xfer write = {
              .address = SHTC1_ADDRESS,
-             .data_length = COMMAND_SIZE,
-             .data = (uint8_t *)CMD_MEASURE_LPM,
-             .ten_bit_address = false,
-             .high_speed = false,
+             .flags = SHTC1_XFER_NO_STOP,
+             .speed_khz = dev->xfer.speed_khz,
+             .timeout_us = dev->xfer.timeout_us,
+             .length = COMMAND_SIZE,
+             .data = (uint8_t *)command,
      };
-     return i2c_master_write_packet_wait_no_stop(i2c_master_instance_ptr, &packet);
+     enum status_code ret = shtc1_lock(dev);
+ 
+     if (ret)
+         return ret;
+ 
+     if (!dev->transport->write_read) {
+         ret = shtc1_write_command(dev, command, false);
+         if (ret == STATUS_OK)
+             ret = shtc1_read_buffer(dev, length);
+     } else {
+         ret = shtc1_select(dev);
+         if (ret == STATUS_OK) {
+             dev->xfer.flags = 0;
+             dev->xfer.length = length;
+             dev->xfer.data = dev->buffer;
+             ret = SHTC1_COUNT_XFER(dev, dev->transport->write_read(dev->transport,
+                     &write, &dev->xfer));
+         }
+     }
+     shtc1_unlock(dev);
+     return ret;
  }
  
- enum status_code shtc1_read_hpm_async(struct i2c_master_module *i2c_master_instance_ptr)
+ void shtc1_enable_sleep(struct shtc1_dev *dev, bool auto_sleep)
  {
-     struct i2c_master_packet packet = {
-             .address = SHTC1_ADDRESS,
-             .data_length = COMMAND_SIZE,
-             .data = (uint8_t *)CMD_MEASURE_HPM,
-             .ten_bit_address = false,
-             .high_speed = false,
-     };
-     return i2c_master_write_packet_wait_no_stop(i2c_master_instance_ptr, &packet);
+     dev->sleep_supported = true;
+     dev->auto_sleep = auto_sleep;
+     dev->power_state = SHTC1_POWER_AWAKE;
+     dev->wake_holds = 0;
  }
  
- enum status_code shtc1_reset(struct i2c_master_module *i2c_master_instance_ptr)
+ enum status_code shtc1_sleep(struct shtc1_dev *dev)
  {
-     struct i2c_master_packet packet = {
-             .address = SHTC1_ADDRESS,
-             .data_length = COMMAND_SIZE,
-             .data = (uint8_t *)CMD_SOFT_RESET,
-             .ten_bit_address = false,
-             .high_speed = false,
-     };
-     return i2c_master_write_packet_wait(i2c_master_instance_ptr, &packet);
+     enum status_code ret;
+ 
+     if (!dev->sleep_supported || dev->power_state == SHTC1_POWER_SLEEP)
+         return STATUS_OK;
+ 
+     ret = shtc1_send_command(dev, CMD_SLEEP);
+     if (ret)
+         return ret;
+     dev->power_state = SHTC1_POWER_SLEEP;
+     return STATUS_OK;
  }
  
- bool shtc1_probe(struct i2c_master_module *i2c_master_instance_ptr)
+ enum status_code shtc1_wakeup(struct shtc1_dev *dev)
  {
-     uint8_t data[3];
-     struct i2c_master_packet packet = {
-             .address = SHTC1_ADDRESS,
-             .data_length = COMMAND_SIZE,
-             .data = (uint8_t *)CMD_READ_ID_REG,
-             .ten_bit_address = false,
-             .high_speed = false,
-     };
-     
-     i2c_master_write_packet_wait_no_stop(i2c_master_instance_ptr, &packet);
-     packet.data_length = sizeof(data);
-     packet.data = data;
-     
-     delay_ms(50);
+     enum status_code ret;
+ 
+     if (!dev->sleep_supported || dev->power_state == SHTC1_POWER_AWAKE)
+         return STATUS_OK;
+ 
+     ret = shtc1_send_command(dev, CMD_WAKEUP);
+     if (ret)
+         return ret;
+     SHTC1_TRANSPORT_DELAY_US(dev->transport, WAKEUP_DURATION_US);
+     dev->power_state = SHTC1_POWER_AWAKE;
+     return STATUS_OK;
+ }
+ 
+ /* puts the sensor back to sleep after a measurement unless a wake window is open */
+ static void shtc1_release(struct shtc1_dev *dev)
+ {
+     if (dev->auto_sleep && !dev->wake_holds)
+         shtc1_sleep(dev);
+ }
+ 
+ enum status_code shtc1_wake_window_begin(struct shtc1_dev *dev)
+ {
+     enum status_code ret = shtc1_wakeup(dev);
+ 
+     if (ret)
+         return ret;
+     ++dev->wake_holds;
+     return STATUS_OK;
+ }
+ 
+ enum status_code shtc1_wake_window_end(struct shtc1_dev *dev)
+ {
+     if (dev->wake_holds)
+         --dev->wake_holds;
+     if (!dev->auto_sleep || dev->wake_holds)
+         return STATUS_OK;
+     return shtc1_sleep(dev);
+ }
+ 
+ #if SHTC1_CONFIG_SYNC || SHTC1_CONFIG_ASYNC
+ /* validates a frame read into the buffer of the device */
+ static enum status_code shtc1_check_buffer(struct shtc1_dev *dev)
+ {
+     if (!shtc1_check_frame(dev->buffer)) {
+         SHTC1_COUNT(dev, crc_errors);
+         return STATUS_ERR_BAD_DATA;
+     }
+     SHTC1_COUNT_LATENCY(dev);
+     return STATUS_OK;
+ }
+ 
+ /* selects the sensor and reads a measurement frame as one locked transaction */
+ static enum status_code shtc1_read_frame(struct shtc1_dev *dev)
+ {
+     enum status_code ret = shtc1_lock(dev);
+ 
+     if (ret)
+         return ret;
+     /* another sensor behind the multiplexer may have been accessed meanwhile */
+     ret = shtc1_select(dev);
+     if (ret == STATUS_OK)
+         ret = shtc1_read_buffer(dev, SHTC1_FRAME_SIZE);
+     shtc1_unlock(dev);
      
-     enum status_code ret = i2c_master_read_packet_wait(i2c_master_instance_ptr, &packet);
+     if (ret)
+         return ret;
+     return shtc1_check_buffer(dev);
+ }
+ 
+ static enum status_code shtc1_read_result(struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     enum status_code ret = shtc1_read_frame(dev);
  
      if (ret)
-         return false;
+         return ret;
+ 
+     shtc1_convert_frame(dev->buffer, temp, rh);
+     return STATUS_OK;
+ }
  
-     if (!shtc1_check_crc(data, 2, data[2]))
+ #endif
+ 
+ #if SHTC1_CONFIG_ASYNC
+ enum status_code shtc1_read_async_result_raw(struct shtc1_dev *dev,
+         uint16_t *raw_t, uint16_t *raw_rh)
+ {
+     enum status_code ret = shtc1_read_frame(dev);
+ 
+     shtc1_release(dev);
+     if (ret)
+         return ret;
+ 
+     *raw_t = shtc1_frame_raw_t(dev->buffer);
+     *raw_rh = shtc1_frame_raw_rh(dev->buffer);
+     return STATUS_OK;
+ }
+ 
+ enum status_code shtc1_read_async_result(struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     enum status_code ret = shtc1_read_result(dev, temp, rh);
+ 
+     shtc1_release(dev);
+     return ret;
+ }
+ 
+ void shtc1_poll_get_config_defaults(struct shtc1_poll_config *config,
+         enum shtc1_mode mode)
+ {
+     config->initial_delay_us = 0;
+     mode = shtc1_effective_mode(mode);
+     config->backoff_us = POLL_BACKOFF_US[mode];
+     config->max_attempts = MEASUREMENT_DURATION_US[mode] / POLL_BACKOFF_US[mode] + 2;
+ }
+ 
+ enum status_code shtc1_poll_result(struct shtc1_dev *dev,
+         const struct shtc1_poll_config *config, int *temp, int *rh)
+ {
+     enum status_code ret;
+     uint16_t attempt;
+ 
+     if (config->initial_delay_us)
+         SHTC1_TRANSPORT_DELAY_US(dev->transport, config->initial_delay_us);
+ 
+     /* the bus is only locked for the readout attempts, not for the backoff */
+     for (attempt = 1; ; ++attempt) {
+         ret = shtc1_read_result(dev, temp, rh);
+         /* an address NACK means the conversion is still running */
+         if (ret != STATUS_ERR_BAD_ADDRESS)
+             break;
+         if (attempt >= config->max_attempts) {
+             ret = STATUS_ERR_TIMEOUT;
+             break;
+         }
+         SHTC1_TRANSPORT_DELAY_US(dev->transport, config->backoff_us);
+     }
+     shtc1_release(dev);
+     return ret;
+ }
+ 
+ #endif
+ 
+ #if SHTC1_CONFIG_SYNC
+ static enum status_code shtc1_read_sync_once(struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     enum shtc1_mode mode = shtc1_effective_mode(dev->mode);
+     enum status_code ret;
+ 
+     dev->last_start_us = shtc1_get_timestamp_us(dev);
+ #ifdef SHTC1_CLOCK_STRETCHING
+     /* stretching would hold a shared bus for the whole conversion */
+     if (!dev->transport->lock) {
+         /* the sensor holds the clock until the result is ready, one transaction */
+         ret = shtc1_command_read(dev, CMD_MEASURE_CS[mode], SHTC1_FRAME_SIZE);
+         if (ret)
+             return ret;
+         ret = shtc1_check_buffer(dev);
+         if (ret)
+             return ret;
+         shtc1_convert_frame(dev->buffer, temp, rh);
+         return STATUS_OK;
+     }
+ #endif
+     /* the stop condition releases the bus for the duration of the conversion */
+     ret = shtc1_send_command(dev, CMD_MEASURE[mode]);
+     if (ret)
+         return ret;
+ 
+     /* wait for the worst case, a task blocks here if the transport sleeps */
+     SHTC1_TRANSPORT_DELAY_US(dev->transport, MEASUREMENT_DURATION_US[mode]);
+ 
+     return shtc1_read_result(dev, temp, rh);
+ }
+ 
+ enum status_code shtc1_read_sync(struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     enum status_code ret = shtc1_wakeup(dev);
+     uint32_t backoff_us = dev->retry.backoff_us;
+     uint8_t retry;
+ 
+     if (ret)
+         return ret;
+     ret = shtc1_read_sync_once(dev, temp, rh);
+     for (retry = 0; ret != STATUS_OK && retry < dev->retry.max_retries; ++retry) {
+         /* a sensor stuck in clock stretching holds the bus */
+         if (dev->retry.recover_bus && dev->transport->recover &&
+                 (ret == STATUS_ERR_TIMEOUT || ret == STATUS_ERR_PACKET_COLLISION) &&
+                 shtc1_lock(dev) == STATUS_OK) {
+             dev->transport->recover(dev->transport);
+             shtc1_unlock(dev);
+         }
+         if (dev->retry.reset && shtc1_reset(dev) == STATUS_OK)
+             SHTC1_TRANSPORT_DELAY_US(dev->transport, SOFT_RESET_DURATION_US);
+         if (backoff_us)
+             SHTC1_TRANSPORT_DELAY_US(dev->transport, backoff_us);
+         backoff_us = backoff_us > MAX_BACKOFF_US / 2 ? MAX_BACKOFF_US : backoff_us * 2;
+         SHTC1_COUNT(dev, retries);
+ 
+         ret = shtc1_read_sync_once(dev, temp, rh);
+     }
+     shtc1_release(dev);
+     return ret;
+ }
+ 
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_LPM
+ enum status_code shtc1_read_lpm_sync(struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     dev->mode = SHTC1_MODE_LPM;
+     return shtc1_read_sync(dev, temp, rh);
+ }
+ 
+ #endif
+ 
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_HPM
+ enum status_code shtc1_read_hpm_sync(struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     dev->mode = SHTC1_MODE_HPM;
+     return shtc1_read_sync(dev, temp, rh);
+ }
+ 
+ #endif
+ #endif
+ 
+ #if SHTC1_CONFIG_ASYNC
+ enum status_code shtc1_read_async(struct shtc1_dev *dev)
+ {
+     enum status_code ret = shtc1_wakeup(dev);
+ 
+     if (ret)
+         return ret;
+     dev->last_start_us = shtc1_get_timestamp_us(dev);
+     /* the stop condition releases the bus for the duration of the conversion */
+     return shtc1_send_command(dev, CMD_MEASURE[shtc1_effective_mode(dev->mode)]);
+ }
+ 
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_LPM
+ enum status_code shtc1_read_lpm_async(struct shtc1_dev *dev)
+ {
+     dev->mode = SHTC1_MODE_LPM;
+     return shtc1_read_async(dev);
+ }
+ 
+ #endif
+ 
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_HPM
+ enum status_code shtc1_read_hpm_async(struct shtc1_dev *dev)
+ {
+     dev->mode = SHTC1_MODE_HPM;
+     return shtc1_read_async(dev);
+ }
+ 
+ #endif
+ #endif
+ 
+ enum status_code shtc1_reset(struct shtc1_dev *dev)
+ {
+     enum status_code ret = shtc1_wakeup(dev);
+ 
+     if (ret)
+         return ret;
+     SHTC1_COUNT(dev, resets);
+     return shtc1_send_command(dev, CMD_SOFT_RESET);
+ }
+ 
+ enum status_code shtc1_read_id(struct shtc1_dev *dev, uint16_t *id)
+ {
+     enum status_code ret = shtc1_wakeup(dev);
+ 
+     if (ret)
+         return ret;
+     /* the ID register is available immediately */
+     ret = shtc1_command_read(dev, CMD_READ_ID_REG, 3);
+     shtc1_release(dev);
+     if (ret)
+         return ret;
+     if (shtc1_crc8(dev->buffer, 2) != dev->buffer[2]) {
+         SHTC1_COUNT(dev, crc_errors);
+         return STATUS_ERR_BAD_DATA;
+     }
+ 
+     *id = (uint16_t)((dev->buffer[0] << 8) | dev->buffer[1]);
+     return STATUS_OK;
+ }
+ 
+ bool shtc1_probe(struct shtc1_dev *dev)
+ {
+     uint16_t id;
+ 
+     if (shtc1_read_id(dev, &id))
          return false;
  
-     return (data[1] & ID_REG_MASK) == ID_REG_CONTENT;
+     return (id & ID_REG_MASK) == ID_REG_CONTENT;
+ }
+ 
+ uint8_t shtc1_probe_all(struct shtc1_dev *devs, uint8_t count, uint32_t *presence)
+ {
+     uint8_t detected = 0;
+     uint8_t i;
+ 
+     for (i = 0; i < (count + 31) / 32; ++i)
+         presence[i] = 0;
+ 
+     for (i = 0; i < count; ++i) {
+         if (shtc1_probe(&devs[i])) {
+             presence[i / 32] |= (uint32_t)1 << (i % 32);
+             ++detected;
+         }
+     }
+     return detected;
  }
\ No newline at end of file
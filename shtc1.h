@@ -19,8 +19,9 @@
  *
  * \brief Sensirion SHTC1 driver interface
  *
- * This module provides access to the SHTC1 functionality over the ASF I2C
- * interface. It allows measurements in normal and clock stretching
+ * This module provides access to the SHTC1 functionality over an I2C
+ * transport, see shtc1_transport.h and the ASF implementation in shtc1_asf.h.
+ * It allows measurements in normal and clock stretching
  * mode as well as executing a soft reset command.
  */
 
@@ -28,89 +29,569 @@
  #define SHTC1_H_
  
  #include "status_codes.h"
+ #include "shtc1_config.h"
+ #include "shtc1_transport.h"
+ 
+ /** size of a measurement result: T (CRC) RH (CRC) */
+ #define SHTC1_FRAME_SIZE 6
  
  /**
-  * Performs a measurement in high precision mode using clock stretching. This
-  * command blocks the TWI bus until the sensor returns the measured values.
-  * A measurement takes about 10.8 ms to complete.
-  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent.
+  * Measurement modes of the sensor.
+  */
+ enum shtc1_mode {
+     /** low power mode, about 0.7 ms per measurement */
+     SHTC1_MODE_LPM,
+     /** high precision mode, about 10.8 ms per measurement */
+     SHTC1_MODE_HPM,
+ };
+ 
+ /* SCL frequencies supported by the sensor in kHz */
+ #define SHTC1_SPEED_STANDARD  100
+ #define SHTC1_SPEED_FAST      400
+ #define SHTC1_SPEED_FAST_PLUS 1000
+ 
+ /* mux_address of a sensor that is connected without a multiplexer */
+ #define SHTC1_NO_MUX 0
+ 
+ /**
+  * Retry policy of the synchronous measurements, see shtc1_set_retry_policy().
+  */
+ struct shtc1_retry_policy {
+     /** additional attempts after a failed measurement */
+     uint8_t max_retries;
+     /**
+      * wait before the first retry in microseconds, doubled for every further
+      * one up to 100 ms
+      */
+     uint16_t backoff_us;
+     /** send a soft reset before every retry */
+     bool reset;
+     /** clock out a stuck bus before a retry that follows a timeout or bus error */
+     bool recover_bus;
+ };
+ 
+ #ifdef SHTC1_STATS
+ /** latency histogram buckets: below 1, 2, 4, 8, 16, 32, 64 ms and above */
+ #define SHTC1_STATS_BUCKETS 8
+ 
+ /**
+  * Counters of a device handle since shtc1_init() or shtc1_clear_stats().
+  */
+ struct shtc1_stats {
+     /** transfers to the sensor and its multiplexer */
+     uint32_t transactions;
+     /** frames and ID register reads with a checksum mismatch */
+     uint32_t crc_errors;
+     /** transfers the sensor or the multiplexer did not acknowledge */
+     uint32_t nacks;
+     /** retries of synchronous measurements */
+     uint32_t retries;
+     /** soft resets sent */
+     uint32_t resets;
+     /**
+      * time from the start of a measurement to its valid result, bucket n
+      * counts latencies below 2^n ms, the last one all longer ones. Only
+      * recorded if the transport has a time base.
+      */
+     uint32_t latency[SHTC1_STATS_BUCKETS];
+ };
+ #endif
+ 
+ /**
+  * Power states of a sensor with sleep support, see shtc1_enable_sleep().
+  */
+ enum shtc1_power_state {
+     /** the sensor accepts commands */
+     SHTC1_POWER_AWAKE,
+     /** the sensor only accepts the wakeup command */
+     SHTC1_POWER_SLEEP,
+ };
+ 
+ /**
+  * Handle of a single sensor. Initialize with shtc1_init(), the members are
+  * maintained by the driver.
+  */
+ struct shtc1_dev {
+     struct shtc1_transport *transport;
+     /** address of a PCA9548A style multiplexer or SHTC1_NO_MUX */
+     uint8_t mux_address;
+     /** channel selection byte for the multiplexer */
+     uint8_t mux_mask;
+     /** mode of measurements started with shtc1_read_sync()/shtc1_read_async() */
+     enum shtc1_mode mode;
+     /** shtc1_get_timestamp_us() at the start of the last measurement */
+     uint32_t last_start_us;
+     struct shtc1_retry_policy retry;
+     /** the sensor supports the sleep and wakeup commands */
+     bool sleep_supported;
+     /** put the sensor to sleep after every measurement outside a wake window */
+     bool auto_sleep;
+     enum shtc1_power_state power_state;
+     /** nesting depth of shtc1_wake_window_begin() */
+     uint8_t wake_holds;
+     /** preset with the address of the sensor */
+     struct shtc1_xfer xfer;
+     uint8_t buffer[SHTC1_FRAME_SIZE];
+ #ifdef SHTC1_STATS
+     struct shtc1_stats stats;
+ #endif
+ };
+ 
+ /**
+  * Initializes a device handle. No bus access is performed.
+  *
+  * @param dev         the handle to initialize
+  * @param transport   the transport of the bus the sensor is connected to
+  * @param mux_address address of the multiplexer in front of the sensor or
+  *                    SHTC1_NO_MUX
+  * @param mux_channel the multiplexer channel the sensor is connected to
+  */
+ void shtc1_init(struct shtc1_dev *dev, struct shtc1_transport *transport,
+         uint8_t mux_address, uint8_t mux_channel);
+ 
+ /**
+  * Sets the SCL frequency used for all transfers to the sensor. Multiplexer
+  * accesses always use the configured speed of the bus.
+  *
+  * @param dev       the device handle
+  * @param speed_khz the SCL frequency in kHz, up to SHTC1_SPEED_FAST_PLUS, or 0
+  *                  for the configured speed of the bus
+  */
+ void shtc1_set_bus_speed(struct shtc1_dev *dev, uint16_t speed_khz);
+ 
+ /**
+  * Bounds every transfer to the sensor, including the time the sensor
+  * stretches the clock during a measurement. A transfer exceeding the timeout
+  * fails with STATUS_ERR_TIMEOUT.
+  *
+  * @param dev        the device handle
+  * @param timeout_us the timeout in microseconds, 0 for the transport default
+  */
+ void shtc1_set_timeout(struct shtc1_dev *dev, uint16_t timeout_us);
+ 
+ /**
+  * Sets how shtc1_read_sync() and its variants handle failed measurements.
+  * With a timeout set by shtc1_set_timeout() a sample then takes at most
+  * (max_retries + 1) attempts of the timeout plus the conversion time, plus
+  * the backoff times. The default policy does not retry.
+  *
+  * @param dev    the device handle
+  * @param policy the policy, copied into the device handle
+  */
+ void shtc1_set_retry_policy(struct shtc1_dev *dev, const struct shtc1_retry_policy *policy);
+ 
+ /**
+  * Calculates the time a measurement of the device occupies the bus: the
+  * command write and the readout without clock stretching, plus the
+  * multiplexer selection for both if the device is behind a multiplexer.
+  *
+  * @param dev the device handle
+  * @return    the bus time per measurement in microseconds
+  */
+ uint32_t shtc1_get_bus_time_us(const struct shtc1_dev *dev);
+ 
+ /**
+  * Calculates how many sensors connected like the given device fit on one bus
+  * when each is sampled at the given rate with pipelined measurements.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev            the device handle
+  * @param sample_rate_hz the measurements per second of each sensor
+  * @return               the number of sensors, 0 if a single sensor can not
+  *                       be sampled at that rate in the mode of the device
+  */
+ uint16_t shtc1_get_max_sensors_per_bus(const struct shtc1_dev *dev, uint16_t sample_rate_hz);
+ 
+ /**
+  * Returns the free running microsecond timestamp of the transport of a
+  * device, or 0 if the transport has no time base.
+  *
+  * @param dev the device handle
+  * @return    the current time in microseconds
+  */
+ uint32_t shtc1_get_timestamp_us(const struct shtc1_dev *dev);
+ 
+ /**
+  * Returns the maximum conversion time of a measurement in the given mode as
+  * specified in the datasheet.
+  *
+  * @param mode the measurement mode
+  * @return     the maximum conversion time in microseconds
+  */
+ uint16_t shtc1_get_max_duration_us(enum shtc1_mode mode);
+ 
+ #ifdef SHTC1_STATS
+ /**
+  * Copies the counters of a device handle. Only transfers issued by this
+  * module are counted, not those of the state machine in shtc1_async.h.
+  *
+  * @param dev   the device handle
+  * @param stats receives the counters
+  */
+ void shtc1_get_stats(const struct shtc1_dev *dev, struct shtc1_stats *stats);
+ 
+ /**
+  * Resets all counters of a device handle to zero.
+  *
+  * @param dev the device handle
+  */
+ void shtc1_clear_stats(struct shtc1_dev *dev);
+ #endif
+ 
+ /**
+  * Calculates the CRC-8 checksum (polynomial 0x31, initialization 0xff) used
+  * by the sensor over the given data.
+  *
+  * @param data        the data to calculate the checksum for
+  * @param data_length the number of bytes in data
+  * @return            the checksum
+  */
+ uint8_t shtc1_crc8(const uint8_t *data, uint8_t data_length);
+ 
+ /**
+  * Validates both checksums of a measurement result frame as read from the
+  * sensor.
+  *
+  * @param frame the SHTC1_FRAME_SIZE bytes T (CRC) RH (CRC)
+  * @return      true if both checksums match
+  */
+ bool shtc1_check_frame(const uint8_t *frame);
+ 
+ #if SHTC1_CONFIG_SYNC
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_HPM
+ /**
+  * Performs a measurement in high precision mode. The measurement command is
+  * sent without clock stretching, the TWI bus is released and the call waits
+  * out the maximum conversion time of 14.4 ms before reading the result. A
+  * measurement takes about 10.8 ms to complete. With SHTC1_CLOCK_STRETCHING on
+  * a transport without lock operations the sensor instead stretches the clock
+  * and the result is read as soon as the conversion has finished.
+  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent, both
+  * in 1/100 with SHTC1_OUTPUT_CENTI.
+  *
+  * @param dev  the device handle
   * @param temp the address for the result of the temperature measurement
   * @param rh   the address for the result of the relative humidity measurement
   * @return     STATUS_OK if the command was successful, else an error code.
   */
- enum status_code shtc1_read_hpm_sync(struct i2c_master_module *i2c_master_instance_ptr,
+ enum status_code shtc1_read_hpm_sync(struct shtc1_dev *dev,
          int *temp, int *rh);
+ #endif
  
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_LPM
  /**
-  * Performs a measurement in low power mode using clock stretching. This
-  * command blocks the TWI bus until the sensor returns the measured values.
-  * A measurement takes about 0.7 ms to complete.
-  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent.
+  * Performs a measurement in low power mode. The measurement command is sent
+  * without clock stretching, the TWI bus is released and the call waits out the
+  * maximum conversion time of 0.94 ms before reading the result. A measurement
+  * takes about 0.7 ms to complete. With SHTC1_CLOCK_STRETCHING on a transport
+  * without lock operations the sensor instead stretches the clock and the
+  * result is read as soon as the conversion has finished.
+  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent, both
+  * in 1/100 with SHTC1_OUTPUT_CENTI.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev  the device handle
   * @param temp the address for the result of the temperature measurement
   * @param rh   the address for the result of the relative humidity measurement
   * @return     STATUS_OK if the command was successful, else an error code.
   */
- enum status_code shtc1_read_lpm_sync(struct i2c_master_module *i2c_master_instance_ptr,
+ enum status_code shtc1_read_lpm_sync(struct shtc1_dev *dev,
          int *temp, int *rh);
+ #endif
  
+ /**
+  * Performs a measurement in the mode of the device handle, see
+  * shtc1_read_hpm_sync() and shtc1_read_lpm_sync().
+  *
+  * @param dev  the device handle
+  * @param temp the address for the result of the temperature measurement
+  * @param rh   the address for the result of the relative humidity measurement
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_read_sync(struct shtc1_dev *dev, int *temp, int *rh);
+ #endif
+ 
+ #if SHTC1_CONFIG_ASYNC
+ /**
+  * Starts a measurement in the mode of the device handle and returns
+  * immediately, see shtc1_read_hpm_async() and shtc1_read_lpm_async().
+  *
+  * @param dev  the device handle
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_read_async(struct shtc1_dev *dev);
+ 
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_HPM
  /**
   * Starts a measurement in high precision mode and returns immediately. Use
   * shtc1_read() to read out the measured value after the measurement has
   * completed.
   * A measurement takes about 10.8 ms to complete.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev  the device handle
   * @return     STATUS_OK if the command was successful, else an error code.
   */
- enum status_code shtc1_read_hpm_async(struct i2c_master_module *i2c_master_instance_ptr);
+ enum status_code shtc1_read_hpm_async(struct shtc1_dev *dev);
+ #endif
  
+ #if SHTC1_CONFIG_MODES & SHTC1_MODES_LPM
  /**
   * Starts a measurement in low power mode and returns immediately. Use
   * shtc1_read() to read out the measured value after the measurement has
   * completed.
   * A measurement takes about 0.7 ms to complete.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev  the device handle
   * @return     STATUS_OK if the command was successful, else an error code.
   */
- enum status_code shtc1_read_lpm_async(struct i2c_master_module *i2c_master_instance_ptr);
+ enum status_code shtc1_read_lpm_async(struct shtc1_dev *dev);
+ #endif
  
  /**
   * Read out the results of a measurement previously started with shtc1_start_lpm()
   " or shtc1_start_hpm().
-  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent.
+  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent, both
+  * in 1/100 with SHTC1_OUTPUT_CENTI.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev  the device handle
   * @param temp the address for the result of the temperature measurement
   * @param rh   the address for the result of the relative humidity measurement
   * @return     STATUS_OK if the command was successful, else an error code.
   */
- enum status_code shtc1_read_async_result(struct i2c_master_module *i2c_master_instance_ptr,
+ enum status_code shtc1_read_async_result(struct shtc1_dev *dev,
          int *temp, int *rh);
  
+ /**
+  * Read out the unconverted sensor signals S_T and S_RH of a measurement
+  * previously started with shtc1_read_async(). The checksums are verified.
+  * Use the shtc1_raw_to_*() helpers to convert the values later on.
+  *
+  * @param dev    the device handle
+  * @param raw_t  the address for the temperature signal
+  * @param raw_rh the address for the relative humidity signal
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_read_async_result_raw(struct shtc1_dev *dev,
+         uint16_t *raw_t, uint16_t *raw_rh);
+ #endif
+ 
+ /**
+  * Converts a temperature signal to 1/1000 C, as returned by
+  * shtc1_read_async_result().
+  * T = 175 * S_T / 2^16 - 45
+  */
+ static inline int32_t shtc1_raw_to_milli_temp(uint16_t raw_t)
+ {
+     return ((21875 * (int32_t)raw_t) >> 13) - 45000;
+ }
+ 
+ /**
+  * Converts a relative humidity signal to 1/1000 percent, as returned by
+  * shtc1_read_async_result().
+  * RH = 100 * S_RH / 2^16
+  */
+ static inline int32_t shtc1_raw_to_milli_rh(uint16_t raw_rh)
+ {
+     return (12500 * (int32_t)raw_rh) >> 13;
+ }
+ 
+ /**
+  * Converts a temperature signal to 1/100 C.
+  */
+ static inline int32_t shtc1_raw_to_centi_temp(uint16_t raw_t)
+ {
+     return ((4375 * (int32_t)raw_t) >> 14) - 4500;
+ }
+ 
+ /**
+  * Converts a relative humidity signal to 1/100 percent.
+  */
+ static inline int32_t shtc1_raw_to_centi_rh(uint16_t raw_rh)
+ {
+     return (625 * (int32_t)raw_rh) >> 12;
+ }
+ 
+ /**
+  * Converts a temperature signal to a fixed point value in C with frac_bits
+  * fractional bits, frac_bits must not exceed 16.
+  */
+ static inline int32_t shtc1_raw_to_q_temp(uint16_t raw_t, uint8_t frac_bits)
+ {
+     return ((175 * (int32_t)raw_t) >> (16 - frac_bits)) - ((int32_t)45 << frac_bits);
+ }
+ 
+ /**
+  * Converts a relative humidity signal to a fixed point value in percent with
+  * frac_bits fractional bits, frac_bits must not exceed 16.
+  */
+ static inline int32_t shtc1_raw_to_q_rh(uint16_t raw_rh, uint8_t frac_bits)
+ {
+     return (100 * (int32_t)raw_rh) >> (16 - frac_bits);
+ }
+ 
+ /**
+  * Converts a temperature signal to C.
+  */
+ static inline float shtc1_raw_to_float_temp(uint16_t raw_t)
+ {
+     return 175.0f * raw_t / 65536.0f - 45.0f;
+ }
+ 
+ /**
+  * Converts a relative humidity signal to percent.
+  */
+ static inline float shtc1_raw_to_float_rh(uint16_t raw_rh)
+ {
+     return 100.0f * raw_rh / 65536.0f;
+ }
+ 
+ /**
+  * Converts buffers of sensor signals to 1/1000 C and 1/1000 percent with the
+  * formulas of shtc1_raw_to_milli_temp() and shtc1_raw_to_milli_rh(). On cores
+  * with the DSP extension two samples are converted per step, elsewhere the
+  * loop is left to the auto-vectorizer of the compiler.
+  *
+  * @param raw_t  the temperature signals
+  * @param raw_rh the relative humidity signals
+  * @param temp   the destination for the temperatures
+  * @param rh     the destination for the relative humidities
+  * @param count  the number of samples in each buffer
+  */
+ void shtc1_convert_batch(const uint16_t *raw_t, const uint16_t *raw_rh,
+         int32_t *temp, int32_t *rh, size_t count);
+ 
+ #if SHTC1_CONFIG_ASYNC
+ /**
+  * Configuration of shtc1_poll_result().
+  */
+ struct shtc1_poll_config {
+     /** time to wait before the first attempt in microseconds */
+     uint16_t initial_delay_us;
+     /** time to wait between two attempts in microseconds */
+     uint16_t backoff_us;
+     /** number of read attempts before giving up */
+     uint16_t max_attempts;
+ };
+ 
+ /**
+  * Initializes a polling configuration that covers the maximum conversion time
+  * of the given mode.
+  *
+  * @param config the configuration to initialize
+  * @param mode   the mode of the measurements to poll for
+  */
+ void shtc1_poll_get_config_defaults(struct shtc1_poll_config *config,
+         enum shtc1_mode mode);
+ 
+ /**
+  * Read out the results of a measurement previously started with
+  * shtc1_read_async() as soon as they are available. The sensor does not
+  * acknowledge its address until the conversion has finished, so the read is
+  * attempted early and repeated after config->backoff_us on every NACK.
+  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent, both
+  * in 1/100 with SHTC1_OUTPUT_CENTI.
+  *
+  * @param dev    the device handle
+  * @param config the polling configuration
+  * @param temp   the address for the result of the temperature measurement
+  * @param rh     the address for the result of the relative humidity measurement
+  * @return       STATUS_OK if the command was successful, STATUS_ERR_TIMEOUT if
+  *               the sensor did not answer within config->max_attempts, else
+  *               an error code.
+  */
+ enum status_code shtc1_poll_result(struct shtc1_dev *dev,
+         const struct shtc1_poll_config *config, int *temp, int *rh);
+ #endif
+ 
+ /**
+  * Enables power management for sensors with sleep and wakeup commands, like
+  * the SHTC3. The driver then tracks the power state, wakes the sensor when a
+  * measurement, a reset or an ID read is requested, and with auto_sleep puts
+  * it back to sleep once the result has been read. The state machine of
+  * shtc1_async.h does not wake the sensor, use a wake window around it.
+  * The sensor is assumed to be awake when this is called.
+  *
+  * @param dev        the device handle
+  * @param auto_sleep sleep after every measurement outside a wake window
+  */
+ void shtc1_enable_sleep(struct shtc1_dev *dev, bool auto_sleep);
+ 
+ /**
+  * Puts the sensor to sleep. Does nothing without shtc1_enable_sleep().
+  *
+  * @param dev  the device handle
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_sleep(struct shtc1_dev *dev);
+ 
+ /**
+  * Wakes the sensor up and waits until it accepts commands. Does nothing if
+  * the sensor is awake or without shtc1_enable_sleep().
+  *
+  * @param dev  the device handle
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_wakeup(struct shtc1_dev *dev);
+ 
+ /**
+  * Starts a wake window: the sensor is woken up once and stays awake across
+  * all measurements until the matching shtc1_wake_window_end(), which saves
+  * the wakeup time and current of every single measurement. Windows nest.
+  *
+  * @param dev  the device handle
+  * @return     STATUS_OK if the sensor is awake, else an error code.
+  */
+ enum status_code shtc1_wake_window_begin(struct shtc1_dev *dev);
+ 
+ /**
+  * Ends a wake window and puts the sensor to sleep if auto sleep is enabled
+  * and no other window is open.
+  *
+  * @param dev  the device handle
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_wake_window_end(struct shtc1_dev *dev);
+ 
  /**
   * @brief Sends a soft reset command to the sensor.
   * The soft reset mechanism forces the sensor into a well defined state without
   * removing the power supply. All internal state machines are reset and
   * calibration data is reloaded from memory.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev  the device handle
   * @return     STATUS_OK if the command was successful, else an error code.
   */
- enum status_code shtc1_reset(struct i2c_master_module *i2c_master_instance_ptr);
+ enum status_code shtc1_reset(struct shtc1_dev *dev);
+ 
+ /**
+  * @brief Reads the ID register of the sensor.
+  * The command and the readout are issued as one repeated start transaction if
+  * the transport supports it, so no other transfer gets in between.
+  *
+  * @param dev the device handle
+  * @param id  the address for the register content
+  * @return     STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_read_id(struct shtc1_dev *dev, uint16_t *id);
  
  /**
   * @brief Detects if a sensor is connected by reading out the ID register.
   * If the sensor does not answer or if the answer is not the expected value,
-  * the test fails.
+  * the test fails. The ID register is read right after the command, a NACK
+  * of the command aborts the probe.
   *
-  * @param i2c_master_instance the i2c master instance pointer
+  * @param dev the device handle
   * @return true if a sensor was detected
   */
- bool shtc1_probe(struct i2c_master_module *i2c_master_instance_ptr);
+ bool shtc1_probe(struct shtc1_dev *dev);
+ 
+ /**
+  * @brief Probes a list of sensors, see shtc1_probe().
+  *
+  * @param devs     the device handles
+  * @param count    the number of device handles
+  * @param presence bitmap of (count + 31) / 32 words, bit i % 32 of word
+  *                 i / 32 is set if devs[i] was detected
+  * @return the number of sensors detected
+  */
+ uint8_t shtc1_probe_all(struct shtc1_dev *devs, uint8_t count, uint32_t *presence);
  
  #endif /* SHTC1_H_ */
\ No newline at end of file
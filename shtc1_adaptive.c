@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 adaptive measurement mode implementation
+ *
+ * This module picks the measurement mode per sample, see shtc1_adaptive.h.
+ */
+
+ #include "shtc1_adaptive.h"
+ 
+ void shtc1_adaptive_get_config_defaults(struct shtc1_adaptive_config *config)
+ {
+     config->temp_threshold = SHTC1_OUTPUT_PER_UNIT / 2;
+     config->rh_threshold = 2 * SHTC1_OUTPUT_PER_UNIT;
+     config->hold_samples = 4;
+     config->calibration_interval = 0;
+ }
+ 
+ void shtc1_adaptive_init(struct shtc1_adaptive *adaptive,
+         const struct shtc1_adaptive_config *config)
+ {
+     adaptive->config = *config;
+     adaptive->last_temp = 0;
+     adaptive->last_rh = 0;
+     adaptive->have_last = false;
+     adaptive->hpm_remaining = 0;
+     adaptive->since_hpm = 0;
+ }
+ 
+ enum shtc1_mode shtc1_adaptive_next_mode(const struct shtc1_adaptive *adaptive)
+ {
+     uint16_t interval = adaptive->config.calibration_interval;
+ 
+     if (!adaptive->have_last || adaptive->hpm_remaining)
+         return SHTC1_MODE_HPM;
+     if (interval && adaptive->since_hpm + 1 >= interval)
+         return SHTC1_MODE_HPM;
+     return SHTC1_MODE_LPM;
+ }
+ 
+ void shtc1_adaptive_update(struct shtc1_adaptive *adaptive, int temp, int rh)
+ {
+     enum shtc1_mode mode = shtc1_adaptive_next_mode(adaptive);
+     int temp_delta = temp - adaptive->last_temp;
+     int rh_delta = rh - adaptive->last_rh;
+ 
+     if (mode == SHTC1_MODE_HPM) {
+         adaptive->since_hpm = 0;
+         if (adaptive->hpm_remaining)
+             --adaptive->hpm_remaining;
+     } else if (adaptive->since_hpm < UINT16_MAX) {
+         ++adaptive->since_hpm;
+     }
+ 
+     /* a change beyond a threshold restarts the high precision hold */
+     if (adaptive->have_last &&
+             (temp_delta > adaptive->config.temp_threshold ||
+             -temp_delta > adaptive->config.temp_threshold ||
+             rh_delta > adaptive->config.rh_threshold ||
+             -rh_delta > adaptive->config.rh_threshold))
+         adaptive->hpm_remaining = adaptive->config.hold_samples;
+ 
+     adaptive->last_temp = temp;
+     adaptive->last_rh = rh;
+     adaptive->have_last = true;
+ }
+ 
+ #if SHTC1_CONFIG_SYNC
+ enum status_code shtc1_adaptive_read_sync(struct shtc1_adaptive *adaptive,
+         struct shtc1_dev *dev, int *temp, int *rh)
+ {
+     enum status_code ret;
+ 
+     dev->mode = shtc1_adaptive_next_mode(adaptive);
+     ret = shtc1_read_sync(dev, temp, rh);
+     if (ret)
+         return ret;
+ 
+     shtc1_adaptive_update(adaptive, *temp, *rh);
+     return STATUS_OK;
+ }
+ #endif
\ No newline at end of file
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 adaptive measurement mode interface
+ *
+ * This module picks the measurement mode per sample: the sensor is sampled in
+ * low power mode while the signals are stable and in high precision mode for
+ * a number of samples after a change beyond a threshold, and optionally every
+ * n-th sample as a calibration point. The decision is kept separate from the
+ * bus access, so it can drive the blocking, polled and non-blocking
+ * measurements alike.
+ */
+
+ #ifndef SHTC1_ADAPTIVE_H_
+ #define SHTC1_ADAPTIVE_H_
+ 
+ #include "shtc1.h"
+ 
+ struct shtc1_adaptive_config {
+     /**
+      * temperature change between two samples that escalates, in 1/1000 C,
+      * 1/100 C with SHTC1_OUTPUT_CENTI
+      */
+     int temp_threshold;
+     /**
+      * humidity change between two samples that escalates, in 1/1000 percent,
+      * 1/100 percent with SHTC1_OUTPUT_CENTI
+      */
+     int rh_threshold;
+     /** samples taken in high precision mode after an escalation */
+     uint8_t hold_samples;
+     /** every n-th sample is taken in high precision mode, 0 to disable */
+     uint16_t calibration_interval;
+ };
+ 
+ struct shtc1_adaptive {
+     struct shtc1_adaptive_config config;
+     /** last accepted sample */
+     int last_temp;
+     int last_rh;
+     bool have_last;
+     /** high precision samples left before returning to low power mode */
+     uint8_t hpm_remaining;
+     /** samples since the last high precision one */
+     uint16_t since_hpm;
+ };
+ 
+ /**
+  * Initializes an adaptive configuration with thresholds of 0.5 C and 2 %RH,
+  * four high precision samples per escalation and no calibration samples.
+  *
+  * @param config the configuration to initialize
+  */
+ void shtc1_adaptive_get_config_defaults(struct shtc1_adaptive_config *config);
+ 
+ /**
+  * Initializes the adaptive state. The first sample is taken in high
+  * precision mode.
+  *
+  * @param adaptive the state to initialize
+  * @param config   the configuration, copied into the state
+  */
+ void shtc1_adaptive_init(struct shtc1_adaptive *adaptive,
+         const struct shtc1_adaptive_config *config);
+ 
+ /**
+  * Returns the mode the next sample should be taken in.
+  *
+  * @param adaptive the adaptive state
+  * @return         the measurement mode
+  */
+ enum shtc1_mode shtc1_adaptive_next_mode(const struct shtc1_adaptive *adaptive);
+ 
+ /**
+  * Feeds a sample taken in the mode returned by shtc1_adaptive_next_mode().
+  *
+  * @param adaptive the adaptive state
+  * @param temp     the temperature in the unit of SHTC1_OUTPUT_FORMAT
+  * @param rh       the relative humidity in the unit of SHTC1_OUTPUT_FORMAT
+  */
+ void shtc1_adaptive_update(struct shtc1_adaptive *adaptive, int temp, int rh);
+ 
+ #if SHTC1_CONFIG_SYNC
+ /**
+  * Measures synchronously in the mode chosen by the adaptive state and feeds
+  * the result back. Failed measurements leave the state unchanged.
+  * Temperature is returned in 1/1000 C and humidity in 1/1000 percent, both
+  * in 1/100 with SHTC1_OUTPUT_CENTI.
+  *
+  * @param adaptive the adaptive state
+  * @param dev      the device handle
+  * @param temp     the address for the result of the temperature measurement
+  * @param rh       the address for the result of the relative humidity measurement
+  * @return         STATUS_OK if the command was successful, else an error code.
+  */
+ enum status_code shtc1_adaptive_read_sync(struct shtc1_adaptive *adaptive,
+         struct shtc1_dev *dev, int *temp, int *rh);
+ #endif
+ 
+ #endif /* SHTC1_ADAPTIVE_H_ */
\ No newline at end of file
@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 transport for the ASF I2C master driver
+ *
+ * This module implements the driver transport on an ASF SERCOM I2C master
+ * instance. The non-blocking operations are available if the ASF driver is
+ * built in callback mode (I2C_MASTER_CALLBACK_MODE). Defining SHTC1_ASF_DMA
+ * in addition enables non-blocking reads through the DMA controller.
+ */
+
+ #include <asf.h>
+ #include <stddef.h>
+ #include "shtc1_asf.h"
+ #include "i2c_master.h"
+ 
+ /* highest SCL frequency the SERCOM supports without high speed mode */
+ #define SHTC1_ASF_MAX_SPEED_KHZ 1000
+ 
+ static inline struct shtc1_asf *shtc1_asf_from(struct shtc1_transport *transport)
+ {
+     return (struct shtc1_asf *)transport;
+ }
+ 
+ static inline void shtc1_asf_prepare(struct shtc1_asf *asf, const struct shtc1_xfer *xfer)
+ {
+     uint32_t timeout = (uint32_t)xfer->timeout_us * SHTC1_ASF_TIMEOUT_LOOPS_PER_US;
+ 
+     asf->i2c_master_instance_ptr->buffer_timeout = !xfer->timeout_us ?
+             asf->default_buffer_timeout : timeout > UINT16_MAX ? UINT16_MAX : (uint16_t)timeout;
+     asf->packet.address = xfer->address;
+     asf->packet.data_length = xfer->length;
+     asf->packet.data = xfer->data;
+ }
+ 
+ static enum status_code shtc1_asf_set_speed(struct shtc1_asf *asf, uint16_t speed_khz)
+ {
+     SercomI2cm *const i2c_module = &(asf->i2c_master_instance_ptr->hw->I2CM);
+     uint32_t fgclk = system_gclk_chan_get_hz(SERCOM0_GCLK_ID_CORE + asf->sercom_index);
+     uint32_t fscl = 1000UL * speed_khz;
+     uint32_t rise = (uint32_t)((uint64_t)fgclk * asf->rise_time_ns * fscl / 1000000000UL);
+     int32_t baud;
+ 
+     if (speed_khz > SHTC1_ASF_MAX_SPEED_KHZ || fgclk <= fscl * 10 + rise)
+         return STATUS_ERR_BAUDRATE_UNAVAILABLE;
+     /* same calculation as the ASF driver, symmetric SCL high and low times */
+     baud = (int32_t)div_ceil(fgclk - fscl * 10 - rise, 2 * fscl);
+     if (baud > 255)
+         return STATUS_ERR_BAUDRATE_UNAVAILABLE;
+ 
+     /* BAUD and SPEED are enable-protected */
+     i2c_master_disable(asf->i2c_master_instance_ptr);
+     i2c_module->BAUD.reg = SERCOM_I2CM_BAUD_BAUD(baud);
+     i2c_module->CTRLA.reg = (i2c_module->CTRLA.reg & ~SERCOM_I2CM_CTRLA_SPEED_Msk) |
+             SERCOM_I2CM_CTRLA_SPEED(speed_khz > 400 ? 1 : 0);
+     i2c_master_enable(asf->i2c_master_instance_ptr);
+ 
+     asf->speed_khz = speed_khz;
+     return STATUS_OK;
+ }
+ 
+ static inline enum status_code shtc1_asf_prepare_speed(struct shtc1_asf *asf,
+         const struct shtc1_xfer *xfer)
+ {
+     /* a transfer without a speed of its own runs at the configured speed of the bus */
+     uint16_t speed_khz = xfer->speed_khz ? xfer->speed_khz : asf->bus_speed_khz;
+ 
+     if (!speed_khz || speed_khz == asf->speed_khz)
+         return STATUS_OK;
+     if (!asf->rise_time_ns)
+         return STATUS_ERR_BAUDRATE_UNAVAILABLE;
+     return shtc1_asf_set_speed(asf, speed_khz);
+ }
+ 
+ static enum status_code shtc1_asf_write(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct shtc1_asf *asf = shtc1_asf_from(transport);
+     enum status_code ret = shtc1_asf_prepare_speed(asf, xfer);
+ 
+     if (ret)
+         return ret;
+     shtc1_asf_prepare(asf, xfer);
+     if (xfer->flags & SHTC1_XFER_NO_STOP)
+         return i2c_master_write_packet_wait_no_stop(asf->i2c_master_instance_ptr, &asf->packet);
+     return i2c_master_write_packet_wait(asf->i2c_master_instance_ptr, &asf->packet);
+ }
+ 
+ static enum status_code shtc1_asf_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct shtc1_asf *asf = shtc1_asf_from(transport);
+     enum status_code ret = shtc1_asf_prepare_speed(asf, xfer);
+ 
+     if (ret)
+         return ret;
+     shtc1_asf_prepare(asf, xfer);
+     if (xfer->flags & SHTC1_XFER_NO_STOP)
+         return i2c_master_read_packet_wait_no_stop(asf->i2c_master_instance_ptr, &asf->packet);
+     return i2c_master_read_packet_wait(asf->i2c_master_instance_ptr, &asf->packet);
+ }
+ 
+ static enum status_code shtc1_asf_write_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *write, const struct shtc1_xfer *read)
+ {
+     struct shtc1_asf *asf = shtc1_asf_from(transport);
+     enum status_code ret;
+ 
+     ret = shtc1_asf_prepare_speed(asf, write);
+     if (ret)
+         return ret;
+ 
+     /* keep other users of the instance off the bus between the two packets */
+     ret = i2c_master_lock(asf->i2c_master_instance_ptr);
+     if (ret)
+         return ret;
+ 
+     shtc1_asf_prepare(asf, write);
+     ret = i2c_master_write_packet_wait_no_stop(asf->i2c_master_instance_ptr, &asf->packet);
+     if (ret == STATUS_OK) {
+         shtc1_asf_prepare(asf, read);
+         ret = i2c_master_read_packet_wait(asf->i2c_master_instance_ptr, &asf->packet);
+     }
+ 
+     i2c_master_unlock(asf->i2c_master_instance_ptr);
+     return ret;
+ }
+ 
+ static void shtc1_asf_release_pin(uint8_t pin)
+ {
+     struct port_config config;
+ 
+     /* open drain high: input with pull-up, the bus pull-ups do the rest */
+     port_get_config_defaults(&config);
+     config.direction = PORT_PIN_DIR_INPUT;
+     config.input_pull = PORT_PIN_PULL_UP;
+     port_pin_set_config(pin, &config);
+ }
+ 
+ static void shtc1_asf_drive_pin_low(uint8_t pin)
+ {
+     struct port_config config;
+ 
+     port_get_config_defaults(&config);
+     config.direction = PORT_PIN_DIR_OUTPUT;
+     port_pin_set_output_level(pin, false);
+     port_pin_set_config(pin, &config);
+ }
+ 
+ static enum status_code shtc1_asf_recover(struct shtc1_transport *transport)
+ {
+     struct shtc1_asf *asf = shtc1_asf_from(transport);
+     uint8_t sda = asf->pinmux_sda >> 16;
+     uint8_t scl = asf->pinmux_scl >> 16;
+     struct system_pinmux_config pinmux;
+     uint8_t pulse;
+ 
+     if (!asf->pinmux_sda || !asf->pinmux_scl)
+         return STATUS_ERR_NOT_INITIALIZED;
+ 
+     i2c_master_disable(asf->i2c_master_instance_ptr);
+     shtc1_asf_release_pin(sda);
+     shtc1_asf_release_pin(scl);
+ 
+     /* clock until the slave releases SDA, 9 pulses finish any byte */
+     for (pulse = 0; pulse < 9 && !port_pin_get_input_level(sda); ++pulse) {
+         shtc1_asf_drive_pin_low(scl);
+         delay_us(5);
+         shtc1_asf_release_pin(scl);
+         delay_us(5);
+     }
+ 
+     /* stop condition: SDA rises while SCL is high */
+     shtc1_asf_drive_pin_low(scl);
+     delay_us(5);
+     shtc1_asf_drive_pin_low(sda);
+     delay_us(5);
+     shtc1_asf_release_pin(scl);
+     delay_us(5);
+     shtc1_asf_release_pin(sda);
+     delay_us(5);
+ 
+     system_pinmux_get_config_defaults(&pinmux);
+     pinmux.mux_position = asf->pinmux_sda & 0xFFFF;
+     system_pinmux_pin_set_config(sda, &pinmux);
+     pinmux.mux_position = asf->pinmux_scl & 0xFFFF;
+     system_pinmux_pin_set_config(scl, &pinmux);
+     i2c_master_enable(asf->i2c_master_instance_ptr);
+ 
+     return port_pin_get_input_level(sda) ? STATUS_OK : STATUS_ERR_IO;
+ }
+ 
+ static void shtc1_asf_delay_us(struct shtc1_transport *transport, uint32_t us)
+ {
+     UNUSED(transport);
+     delay_us(us);
+ }
+ 
+ WEAK uint32_t shtc1_asf_get_timestamp_us(void)
+ {
+     return 0;
+ }
+ 
+ static uint32_t shtc1_asf_timestamp_us(struct shtc1_transport *transport)
+ {
+     UNUSED(transport);
+     return shtc1_asf_get_timestamp_us();
+ }
+ 
+ #if defined(SHTC1_ASF_DMA) && !(I2C_MASTER_CALLBACK_MODE == true)
+ #error SHTC1_ASF_DMA requires the ASF I2C master driver in callback mode
+ #endif
+ 
+ #if I2C_MASTER_CALLBACK_MODE == true
+ /* the ASF callbacks only pass the master instance, map it back to the transport */
+ static struct shtc1_asf *asf_instances[SHTC1_ASF_MAX_BUSES];
+ 
+ static struct shtc1_asf *shtc1_asf_lookup(struct i2c_master_module *const module)
+ {
+     for (uint8_t i = 0; i < SHTC1_ASF_MAX_BUSES; ++i) {
+         if (asf_instances[i] && asf_instances[i]->i2c_master_instance_ptr == module)
+             return asf_instances[i];
+     }
+     return NULL;
+ }
+ 
+ static void shtc1_asf_complete(struct i2c_master_module *const module, enum status_code status)
+ {
+     struct shtc1_asf *asf = shtc1_asf_lookup(module);
+     shtc1_xfer_done_t done;
+ 
+     if (!asf || !asf->done)
+         return;
+     /* the completion may start the next transfer right away */
+     done = asf->done;
+     asf->done = NULL;
+     done(asf->done_arg, status);
+ }
+ 
+ static void shtc1_asf_transfer_complete(struct i2c_master_module *const module)
+ {
+     shtc1_asf_complete(module, STATUS_OK);
+ }
+ 
+ static void shtc1_asf_error(struct i2c_master_module *const module)
+ {
+     shtc1_asf_complete(module, i2c_master_get_job_status(module));
+ }
+ 
+ static enum status_code shtc1_asf_write_async(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg)
+ {
+     struct shtc1_asf *asf = shtc1_asf_from(transport);
+     enum status_code ret = shtc1_asf_prepare_speed(asf, xfer);
+ 
+     if (ret)
+         return ret;
+     shtc1_asf_prepare(asf, xfer);
+     asf->done = done;
+     asf->done_arg = arg;
+     if (xfer->flags & SHTC1_XFER_NO_STOP)
+         ret = i2c_master_write_packet_job_no_stop(asf->i2c_master_instance_ptr, &asf->packet);
+     else
+         ret = i2c_master_write_packet_job(asf->i2c_master_instance_ptr, &asf->packet);
+     if (ret)
+         asf->done = NULL;
+     return ret;
+ }
+ 
+ #ifdef SHTC1_ASF_DMA
+ static struct shtc1_asf *shtc1_asf_lookup_sercom(uint8_t sercom_index)
+ {
+     for (uint8_t i = 0; i < SHTC1_ASF_MAX_BUSES; ++i) {
+         if (asf_instances[i] && asf_instances[i]->dma_enabled &&
+                 asf_instances[i]->sercom_index == sercom_index)
+             return asf_instances[i];
+     }
+     return NULL;
+ }
+ 
+ static void shtc1_asf_dma_finish(struct shtc1_asf *asf, enum status_code status)
+ {
+     SercomI2cm *const i2c_module = &(asf->i2c_master_instance_ptr->hw->I2CM);
+ 
+     i2c_module->INTENCLR.reg = SERCOM_I2CM_INTENSET_MB;
+     /* hand the SERCOM interrupt back to the ASF driver */
+     _sercom_set_handler(asf->sercom_index, _i2c_master_interrupt_handler);
+     shtc1_asf_complete(asf->i2c_master_instance_ptr, status);
+ }
+ 
+ static void shtc1_asf_dma_done(struct dma_resource *const resource)
+ {
+     struct shtc1_asf *asf = (struct shtc1_asf *)((uint8_t *)resource -
+             offsetof(struct shtc1_asf, dma));
+ 
+     shtc1_asf_dma_finish(asf, STATUS_OK);
+ }
+ 
+ /* only entered on address NACK or bus errors, the data bytes are moved by the DMAC */
+ static void shtc1_asf_dma_sercom_handler(uint8_t instance)
+ {
+     struct shtc1_asf *asf = shtc1_asf_lookup_sercom(instance);
+     SercomI2cm *i2c_module;
+     uint16_t status;
+ 
+     if (!asf)
+         return;
+     i2c_module = &(asf->i2c_master_instance_ptr->hw->I2CM);
+     if (!(i2c_module->INTFLAG.reg & SERCOM_I2CM_INTFLAG_MB))
+         return;
+ 
+     status = i2c_module->STATUS.reg;
+     dma_abort_job(&asf->dma);
+     /* send stop, also clears the interrupt flag */
+     i2c_module->CTRLB.reg |= SERCOM_I2CM_CTRLB_CMD(3);
+     shtc1_asf_dma_finish(asf, (status & SERCOM_I2CM_STATUS_RXNACK) ?
+             STATUS_ERR_BAD_ADDRESS : STATUS_ERR_IO);
+ }
+ 
+ static enum status_code shtc1_asf_read_dma(struct shtc1_asf *asf,
+         const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg)
+ {
+     SercomI2cm *const i2c_module = &(asf->i2c_master_instance_ptr->hw->I2CM);
+     struct dma_descriptor_config config;
+     enum status_code ret;
+ 
+     dma_descriptor_get_config_defaults(&config);
+     config.beat_size = DMA_BEAT_SIZE_BYTE;
+     config.src_increment_enable = false;
+     config.dst_increment_enable = true;
+     config.block_transfer_count = xfer->length;
+     config.source_address = (uint32_t)&i2c_module->DATA.reg;
+     /* the DMAC expects the end address of an incrementing destination */
+     config.destination_address = (uint32_t)xfer->data + xfer->length;
+     dma_descriptor_create(&asf->dma_descriptor, &config);
+ 
+     asf->done = done;
+     asf->done_arg = arg;
+     ret = dma_start_transfer_job(&asf->dma);
+     if (ret) {
+         asf->done = NULL;
+         return ret;
+     }
+ 
+     _sercom_set_handler(asf->sercom_index, shtc1_asf_dma_sercom_handler);
+     i2c_module->INTENSET.reg = SERCOM_I2CM_INTENSET_MB;
+     /* the ASF driver runs the master in smart mode, reading DATA acknowledges */
+     while (i2c_master_is_syncing(asf->i2c_master_instance_ptr));
+     i2c_module->ADDR.reg = SERCOM_I2CM_ADDR_ADDR((xfer->address << 1) | 0x01) |
+             SERCOM_I2CM_ADDR_LENEN | SERCOM_I2CM_ADDR_LEN(xfer->length);
+     return STATUS_OK;
+ }
+ 
+ enum status_code shtc1_asf_enable_dma(struct shtc1_asf *asf, uint8_t rx_trigger)
+ {
+     struct dma_resource_config config;
+     enum status_code ret;
+ 
+     dma_get_config_defaults(&config);
+     config.peripheral_trigger = rx_trigger;
+     config.trigger_action = DMA_TRIGGER_ACTON_BEAT;
+     ret = dma_allocate(&asf->dma, &config);
+     if (ret)
+         return ret;
+ 
+     dma_register_callback(&asf->dma, shtc1_asf_dma_done, DMA_CALLBACK_TRANSFER_DONE);
+     dma_enable_callback(&asf->dma, DMA_CALLBACK_TRANSFER_DONE);
+     ret = dma_add_descriptor(&asf->dma, &asf->dma_descriptor);
+     if (ret)
+         return ret;
+ 
+     asf->dma_enabled = true;
+     return STATUS_OK;
+ }
+ #endif
+ 
+ static enum status_code shtc1_asf_read_async(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg)
+ {
+     struct shtc1_asf *asf = shtc1_asf_from(transport);
+     enum status_code ret = shtc1_asf_prepare_speed(asf, xfer);
+ 
+     if (ret)
+         return ret;
+ #ifdef SHTC1_ASF_DMA
+     if (asf->dma_enabled && !(xfer->flags & SHTC1_XFER_NO_STOP))
+         return shtc1_asf_read_dma(asf, xfer, done, arg);
+ #endif
+ 
+     shtc1_asf_prepare(asf, xfer);
+     asf->done = done;
+     asf->done_arg = arg;
+     ret = i2c_master_read_packet_job(asf->i2c_master_instance_ptr, &asf->packet);
+     if (ret)
+         asf->done = NULL;
+     return ret;
+ }
+ 
+ static enum status_code shtc1_asf_register(struct shtc1_asf *asf)
+ {
+     struct i2c_master_module *module = asf->i2c_master_instance_ptr;
+     uint8_t slot;
+ 
+     for (slot = 0; slot < SHTC1_ASF_MAX_BUSES; ++slot) {
+         if (!asf_instances[slot] || asf_instances[slot] == asf ||
+                 asf_instances[slot]->i2c_master_instance_ptr == module)
+             break;
+     }
+     if (slot == SHTC1_ASF_MAX_BUSES)
+         return STATUS_ERR_NO_MEMORY;
+     asf_instances[slot] = asf;
+ 
+     i2c_master_register_callback(module, shtc1_asf_transfer_complete,
+             I2C_MASTER_CALLBACK_WRITE_COMPLETE);
+     i2c_master_register_callback(module, shtc1_asf_transfer_complete,
+             I2C_MASTER_CALLBACK_READ_COMPLETE);
+     i2c_master_register_callback(module, shtc1_asf_error, I2C_MASTER_CALLBACK_ERROR);
+     i2c_master_enable_callback(module, I2C_MASTER_CALLBACK_WRITE_COMPLETE);
+     i2c_master_enable_callback(module, I2C_MASTER_CALLBACK_READ_COMPLETE);
+     i2c_master_enable_callback(module, I2C_MASTER_CALLBACK_ERROR);
+     return STATUS_OK;
+ }
+ #endif
+ 
+ void shtc1_asf_set_bus_config(struct shtc1_asf *asf, const struct i2c_master_config *config)
+ {
+     asf->speed_khz = config->baud_rate;
+     asf->bus_speed_khz = config->baud_rate;
+     asf->rise_time_ns = config->sda_scl_rise_time_ns;
+     asf->pinmux_sda = config->pinmux_pad0;
+     asf->pinmux_scl = config->pinmux_pad1;
+ }
+ 
+ enum status_code shtc1_asf_init(struct shtc1_asf *asf,
+         struct i2c_master_module *i2c_master_instance_ptr)
+ {
+     asf->transport.write = shtc1_asf_write;
+     asf->transport.read = shtc1_asf_read;
+     asf->transport.write_read = shtc1_asf_write_read;
+     asf->transport.delay_us = shtc1_asf_delay_us;
+     asf->transport.timestamp_us = shtc1_asf_timestamp_us;
+     asf->transport.recover = shtc1_asf_recover;
+     asf->transport.lock = NULL;
+     asf->transport.unlock = NULL;
+     asf->transport.write_async = NULL;
+     asf->transport.read_async = NULL;
+     asf->i2c_master_instance_ptr = i2c_master_instance_ptr;
+     asf->packet.ten_bit_address = false;
+     asf->packet.high_speed = false;
+     asf->done = NULL;
+     asf->done_arg = NULL;
+     asf->sercom_index = _sercom_get_sercom_inst_index(i2c_master_instance_ptr->hw);
+     asf->speed_khz = 0;
+     asf->bus_speed_khz = 0;
+     asf->rise_time_ns = 0;
+     asf->default_buffer_timeout = i2c_master_instance_ptr->buffer_timeout;
+     asf->pinmux_sda = 0;
+     asf->pinmux_scl = 0;
+ #ifdef SHTC1_ASF_DMA
+     asf->dma_enabled = false;
+ #endif
+ 
+ #if I2C_MASTER_CALLBACK_MODE == true
+     asf->transport.write_async = shtc1_asf_write_async;
+     asf->transport.read_async = shtc1_asf_read_async;
+     return shtc1_asf_register(asf);
+ #else
+     return STATUS_OK;
+ #endif
+ }
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 transport for the ASF I2C master driver
+ *
+ * This module implements the driver transport on an ASF SERCOM I2C master
+ * instance. The non-blocking operations are available if the ASF driver is
+ * built in callback mode (I2C_MASTER_CALLBACK_MODE). Defining SHTC1_ASF_DMA
+ * in addition enables non-blocking reads through the DMA controller.
+ */
+
+ #ifndef SHTC1_ASF_H_
+ #define SHTC1_ASF_H_
+ 
+ #include "shtc1_transport.h"
+ #include "i2c_master.h"
+ #ifdef SHTC1_ASF_DMA
+ #include "dma.h"
+ #endif
+ 
+ /* number of I2C master instances that can use the non-blocking operations */
+ #ifndef SHTC1_ASF_MAX_BUSES
+ #define SHTC1_ASF_MAX_BUSES 2
+ #endif
+ 
+ /**
+  * Iterations of the ASF bus wait loop per microsecond, used to turn transfer
+  * timeouts into the buffer_timeout of the master instance. Calibrate for the
+  * CPU clock, the default fits 48 MHz.
+  */
+ #ifndef SHTC1_ASF_TIMEOUT_LOOPS_PER_US
+ #define SHTC1_ASF_TIMEOUT_LOOPS_PER_US 4
+ #endif
+ 
+ struct shtc1_asf {
+     struct shtc1_transport transport;
+     struct i2c_master_module *i2c_master_instance_ptr;
+     struct i2c_master_packet packet;
+     shtc1_xfer_done_t done;
+     void *done_arg;
+     uint8_t sercom_index;
+     /** SCL frequency the instance currently runs at in kHz */
+     uint16_t speed_khz;
+     /** configured SCL frequency of the bus in kHz, used by transfers with speed 0 */
+     uint16_t bus_speed_khz;
+     /** SDA/SCL rise time for the baud rate calculation in ns */
+     uint16_t rise_time_ns;
+     /** buffer_timeout of the master instance for transfers without timeout */
+     uint16_t default_buffer_timeout;
+     /** SERCOM pad 0 (SDA) and pad 1 (SCL) pinmux settings for bus recovery */
+     uint32_t pinmux_sda;
+     uint32_t pinmux_scl;
+ #ifdef SHTC1_ASF_DMA
+     struct dma_resource dma;
+     COMPILER_ALIGNED(16) DmacDescriptor dma_descriptor;
+     bool dma_enabled;
+ #endif
+ };
+ 
+ /**
+  * Initializes the transport for an I2C master instance. In callback mode the
+  * I2C callbacks of the instance are registered, other users of the instance
+  * must not register their own callbacks.
+  *
+  * @param asf the transport to initialize
+  * @param i2c_master_instance_ptr the initialized i2c master instance pointer
+  * @return    STATUS_OK if the transport was initialized,
+  *            STATUS_ERR_NO_MEMORY if SHTC1_ASF_MAX_BUSES other master
+  *            instances use the non-blocking operations already
+  */
+ enum status_code shtc1_asf_init(struct shtc1_asf *asf,
+         struct i2c_master_module *i2c_master_instance_ptr);
+ 
+ /**
+  * Tells the transport the bus configuration of the master instance, which
+  * enables switching the SCL frequency for devices configured with
+  * shtc1_set_bus_speed() and bus recovery. The instance is briefly disabled
+  * for every switch, so group devices of the same speed. Without this call
+  * transfers at another speed than the bus are refused with
+  * STATUS_ERR_BAUDRATE_UNAVAILABLE and the bus can not be recovered. Transfers
+  * without a speed of their own, e.g. multiplexer accesses, switch back to the
+  * configured baud rate.
+  *
+  * @param asf    the initialized transport
+  * @param config the configuration the master instance was initialized with
+  */
+ void shtc1_asf_set_bus_config(struct shtc1_asf *asf, const struct i2c_master_config *config);
+ 
+ #ifdef SHTC1_ASF_DMA
+ /**
+  * Allocates a DMA channel for the non-blocking reads of the transport. The
+  * bytes are moved from the SERCOM data register by the DMA controller and the
+  * master sends NACK and stop on its own after the last byte, so a read costs
+  * two interrupts regardless of its length.
+  *
+  * @param asf        the initialized transport
+  * @param rx_trigger the DMAC receive trigger of the SERCOM, e.g. SERCOM2_DMAC_ID_RX
+  * @return           STATUS_OK if the channel was allocated, else an error code.
+  */
+ enum status_code shtc1_asf_enable_dma(struct shtc1_asf *asf, uint8_t rx_trigger);
+ #endif
+ 
+ /**
+  * Returns a free running microsecond timestamp. The default implementation
+  * returns 0, override it to get the start times of measurements recorded.
+  *
+  * @return the current time in microseconds
+  */
+ uint32_t shtc1_asf_get_timestamp_us(void);
+ 
+ #endif /* SHTC1_ASF_H_ */
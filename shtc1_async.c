@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 non-blocking measurement implementation
+ *
+ * This module performs measurements with the non-blocking operations of the
+ * transport. The command write, the conversion and the readout advance as a
+ * state machine from interrupt context and a completion callback is called
+ * with the result, so the CPU is free while a measurement is in flight.
+ */
+
+ #include "shtc1_async.h"
+ #include "shtc1_internal.h"
+ 
+ static void shtc1_async_finish(struct shtc1_async *async, enum status_code status)
+ {
+     int temp = 0;
+     int rh = 0;
+ 
+     if (status == STATUS_OK) {
+         if (shtc1_check_frame(async->dev->buffer))
+             shtc1_convert_frame(async->dev->buffer, &temp, &rh);
+         else
+             status = STATUS_ERR_BAD_DATA;
+     }
+     async->state = SHTC1_ASYNC_IDLE;
+     async->callback(async, status, temp, rh);
+ }
+ 
+ static void shtc1_async_done(void *arg, enum status_code status);
+ 
+ static enum status_code shtc1_async_advance(struct shtc1_async *async)
+ {
+     struct shtc1_dev *dev = async->dev;
+     struct shtc1_transport *transport = dev->transport;
+ 
+     switch (async->state) {
+     case SHTC1_ASYNC_START:
+         /* the stop condition releases the bus for the duration of the conversion */
+         dev->xfer.flags = 0;
+         dev->xfer.length = COMMAND_SIZE;
+         dev->xfer.data = (uint8_t *)CMD_MEASURE[shtc1_effective_mode(dev->mode)];
+         return transport->write_async(transport, &dev->xfer, shtc1_async_done, async);
+     case SHTC1_ASYNC_SELECT:
+     case SHTC1_ASYNC_SELECT_READOUT:
+         return transport->write_async(transport, &async->mux_xfer, shtc1_async_done, async);
+     case SHTC1_ASYNC_READOUT:
+         dev->xfer.flags = 0;
+         dev->xfer.length = SHTC1_FRAME_SIZE;
+         dev->xfer.data = dev->buffer;
+         return transport->read_async(transport, &dev->xfer, shtc1_async_done, async);
+     default:
+         return STATUS_ERR_DENIED;
+     }
+ }
+ 
+ static void shtc1_async_done(void *arg, enum status_code status)
+ {
+     struct shtc1_async *async = arg;
+ 
+     if (status) {
+         shtc1_async_finish(async, status);
+         return;
+     }
+ 
+     switch (async->state) {
+     case SHTC1_ASYNC_SELECT:
+         async->state = SHTC1_ASYNC_START;
+         break;
+     case SHTC1_ASYNC_START:
+         async->state = SHTC1_ASYNC_WAIT;
+         async->start_timer(async, shtc1_get_max_duration_us(async->dev->mode));
+         return;
+     case SHTC1_ASYNC_SELECT_READOUT:
+         async->state = SHTC1_ASYNC_READOUT;
+         break;
+     case SHTC1_ASYNC_READOUT:
+         shtc1_async_finish(async, STATUS_OK);
+         return;
+     default:
+         return;
+     }
+ 
+     status = shtc1_async_advance(async);
+     if (status)
+         shtc1_async_finish(async, status);
+ }
+ 
+ enum status_code shtc1_async_init(struct shtc1_async *async, struct shtc1_dev *dev,
+         shtc1_async_timer_t start_timer, shtc1_async_callback_t callback)
+ {
+     if (!dev->transport->write_async || !dev->transport->read_async)
+         return STATUS_ERR_UNSUPPORTED_DEV;
+ 
+     async->dev = dev;
+     async->start_timer = start_timer;
+     async->callback = callback;
+     async->state = SHTC1_ASYNC_IDLE;
+     async->mux_xfer.address = dev->mux_address;
+     async->mux_xfer.flags = 0;
+     async->mux_xfer.speed_khz = 0;
+     async->mux_xfer.timeout_us = 0;
+     async->mux_xfer.length = sizeof(dev->mux_mask);
+     async->mux_xfer.data = &dev->mux_mask;
+     return STATUS_OK;
+ }
+ 
+ enum status_code shtc1_async_start(struct shtc1_async *async, enum shtc1_mode mode)
+ {
+     struct shtc1_dev *dev = async->dev;
+     enum status_code ret;
+ 
+     if (async->state != SHTC1_ASYNC_IDLE)
+         return STATUS_BUSY;
+ 
+     dev->mode = mode;
+     dev->last_start_us = shtc1_get_timestamp_us(dev);
+     async->state = dev->mux_address == SHTC1_NO_MUX ? SHTC1_ASYNC_START : SHTC1_ASYNC_SELECT;
+ 
+     ret = shtc1_async_advance(async);
+     if (ret)
+         async->state = SHTC1_ASYNC_IDLE;
+     return ret;
+ }
+ 
+ void shtc1_async_timer_expired(struct shtc1_async *async)
+ {
+     enum status_code ret;
+ 
+     if (async->state != SHTC1_ASYNC_WAIT)
+         return;
+ 
+     async->state = async->dev->mux_address == SHTC1_NO_MUX ?
+             SHTC1_ASYNC_READOUT : SHTC1_ASYNC_SELECT_READOUT;
+ 
+     ret = shtc1_async_advance(async);
+     if (ret)
+         shtc1_async_finish(async, ret);
+ }
+
+ static void shtc1_async_frame_selected(void *arg, enum status_code status)
+ {
+     struct shtc1_frame_read *read = arg;
+     struct shtc1_transport *transport = read->dev->transport;
+ 
+     if (status == STATUS_OK)
+         status = transport->read_async(transport, &read->xfer, read->done, read->arg);
+     if (status)
+         read->done(read->arg, status);
+ }
+ 
+ enum status_code shtc1_async_read_frame(struct shtc1_frame_read *read,
+         struct shtc1_dev *dev, uint8_t *frame, shtc1_xfer_done_t done, void *arg)
+ {
+     struct shtc1_transport *transport = dev->transport;
+ 
+     if (!transport->write_async || !transport->read_async)
+         return STATUS_ERR_UNSUPPORTED_DEV;
+ 
+     read->dev = dev;
+     read->xfer.address = SHTC1_ADDRESS;
+     read->xfer.flags = 0;
+     read->xfer.speed_khz = dev->xfer.speed_khz;
+     read->xfer.timeout_us = dev->xfer.timeout_us;
+     read->xfer.length = SHTC1_FRAME_SIZE;
+     read->xfer.data = frame;
+     read->done = done;
+     read->arg = arg;
+ 
+     if (dev->mux_address == SHTC1_NO_MUX)
+         return transport->read_async(transport, &read->xfer, done, arg);
+ 
+     read->mux_xfer.address = dev->mux_address;
+     read->mux_xfer.flags = 0;
+     read->mux_xfer.speed_khz = 0;
+     read->mux_xfer.timeout_us = 0;
+     read->mux_xfer.length = sizeof(dev->mux_mask);
+     read->mux_xfer.data = &dev->mux_mask;
+     return transport->write_async(transport, &read->mux_xfer, shtc1_async_frame_selected, read);
+ }
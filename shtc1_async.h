@@ -0,0 +1,157 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 non-blocking measurement interface
+ *
+ * This module performs measurements with the non-blocking operations of the
+ * transport. The command write, the conversion and the readout advance as a
+ * state machine from interrupt context and a completion callback is called
+ * with the result, so the CPU is free while a measurement is in flight.
+ */
+
+ #ifndef SHTC1_ASYNC_H_
+ #define SHTC1_ASYNC_H_
+ 
+ #include "shtc1.h"
+ 
+ struct shtc1_async;
+ 
+ /**
+  * Called from interrupt context when a measurement has completed.
+  *
+  * @param async  the measurement the result belongs to
+  * @param status STATUS_OK if the measurement was successful, else an error code
+  * @param temp   the temperature in 1/1000 C, 1/100 C with SHTC1_OUTPUT_CENTI,
+  *               only valid on STATUS_OK
+  * @param rh     the relative humidity in 1/1000 percent, 1/100 percent with
+  *               SHTC1_OUTPUT_CENTI, only valid on STATUS_OK
+  */
+ typedef void (*shtc1_async_callback_t)(struct shtc1_async *async,
+         enum status_code status, int temp, int rh);
+ 
+ /**
+  * Arms a one-shot timer of the application. When it expires the application
+  * must call shtc1_async_timer_expired(). The function is called from interrupt
+  * context.
+  *
+  * @param async      the measurement waiting for the timer
+  * @param timeout_us the time to wait in microseconds
+  */
+ typedef void (*shtc1_async_timer_t)(struct shtc1_async *async, uint16_t timeout_us);
+ 
+ enum shtc1_async_state {
+     SHTC1_ASYNC_IDLE,
+     /** the multiplexer is switched to the sensor before the start */
+     SHTC1_ASYNC_SELECT,
+     /** the measurement command is being written */
+     SHTC1_ASYNC_START,
+     /** the sensor is converting, the bus is free */
+     SHTC1_ASYNC_WAIT,
+     /** the multiplexer is switched to the sensor before the readout */
+     SHTC1_ASYNC_SELECT_READOUT,
+     /** the measurement result is being read */
+     SHTC1_ASYNC_READOUT,
+ };
+ 
+ struct shtc1_async {
+     struct shtc1_dev *dev;
+     shtc1_async_timer_t start_timer;
+     shtc1_async_callback_t callback;
+     /** free for use by the application */
+     void *user_data;
+ 
+     volatile enum shtc1_async_state state;
+     struct shtc1_xfer mux_xfer;
+ };
+ 
+ /**
+  * A non-blocking readout of a measurement frame into a buffer of the caller.
+  */
+ struct shtc1_frame_read {
+     struct shtc1_dev *dev;
+     struct shtc1_xfer mux_xfer;
+     struct shtc1_xfer xfer;
+     shtc1_xfer_done_t done;
+     void *arg;
+ };
+ 
+ /**
+  * Starts reading the measurement frame of a measurement previously started
+  * with shtc1_read_async() into frame and returns immediately. With a DMA
+  * capable transport the bytes are moved without CPU involvement. The frame is
+  * not checked, use shtc1_check_frame() in the completion.
+  *
+  * @param read  storage for the readout, must stay valid until done is called
+  * @param dev   the device handle, its transport must provide the non-blocking
+  *              operations
+  * @param frame the destination, SHTC1_FRAME_SIZE bytes
+  * @param done  called once the frame has been read or the readout failed
+  * @param arg   passed to done
+  * @return      STATUS_OK if the readout was started, else an error code.
+  */
+ enum status_code shtc1_async_read_frame(struct shtc1_frame_read *read,
+         struct shtc1_dev *dev, uint8_t *frame, shtc1_xfer_done_t done, void *arg);
+ 
+ /**
+  * Initializes a non-blocking measurement context. The transfer and buffer of
+  * the device handle are used for the transfers.
+  *
+  * @param async       the context to initialize
+  * @param dev         the device handle, its transport must provide the
+  *                    non-blocking operations
+  * @param start_timer arms the conversion timer of the application
+  * @param callback    called with the result of every measurement
+  * @return            STATUS_OK if the context was initialized,
+  *                    STATUS_ERR_UNSUPPORTED_DEV if the transport has no
+  *                    non-blocking operations
+  */
+ enum status_code shtc1_async_init(struct shtc1_async *async, struct shtc1_dev *dev,
+         shtc1_async_timer_t start_timer, shtc1_async_callback_t callback);
+ 
+ /**
+  * Starts a measurement and returns immediately. The callback of the context
+  * is called once the measurement has completed or failed.
+  *
+  * @param async the context to measure with
+  * @param mode  the measurement mode
+  * @return      STATUS_OK if the measurement was started, STATUS_BUSY if a
+  *              measurement is in flight on the context or the bus, else an
+  *              error code.
+  */
+ enum status_code shtc1_async_start(struct shtc1_async *async, enum shtc1_mode mode);
+ 
+ /**
+  * Reads out the measurement result. Must be called by the application when
+  * the timer armed through start_timer has expired.
+  *
+  * @param async the context the timer was armed for
+  */
+ void shtc1_async_timer_expired(struct shtc1_async *async);
+ 
+ /**
+  * @param async the context to check
+  * @return true if a measurement is in flight
+  */
+ static inline bool shtc1_async_busy(const struct shtc1_async *async)
+ {
+     return async->state != SHTC1_ASYNC_IDLE;
+ }
+ 
+ #endif /* SHTC1_ASYNC_H_ */
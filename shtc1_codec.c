@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 delta/varint sample stream codec implementation
+ *
+ * This module compresses a stream of raw signals, see shtc1_codec.h.
+ */
+
+ #include "shtc1_codec.h"
+ 
+ #define CODEC_KEYFRAME 1
+ 
+ /* the wrapped difference of two signals as a signed value */
+ static inline int32_t shtc1_codec_delta(uint16_t value, uint16_t reference)
+ {
+     return (int16_t)(uint16_t)(value - reference);
+ }
+ 
+ uint8_t shtc1_varint_put(uint8_t *buffer, uint32_t value)
+ {
+     uint8_t size = 0;
+ 
+     while (value >= 0x80) {
+         buffer[size++] = (uint8_t)(value | 0x80);
+         value >>= 7;
+     }
+     buffer[size++] = (uint8_t)value;
+     return size;
+ }
+ 
+ uint8_t shtc1_varint_get(const uint8_t *buffer, uint16_t available, uint32_t *value)
+ {
+     uint8_t size = 0;
+ 
+     *value = 0;
+     do {
+         if (size >= available || size >= SHTC1_VARINT_MAX_SIZE)
+             return 0;
+         *value |= (uint32_t)(buffer[size] & 0x7f) << (7 * size);
+     } while (buffer[size++] & 0x80);
+     return size;
+ }
+ 
+ void shtc1_encoder_init(struct shtc1_encoder *encoder, uint16_t keyframe_interval)
+ {
+     encoder->last_t = 0;
+     encoder->last_rh = 0;
+     encoder->keyframe_interval = keyframe_interval;
+     shtc1_encoder_force_keyframe(encoder);
+ }
+ 
+ void shtc1_encoder_force_keyframe(struct shtc1_encoder *encoder)
+ {
+     encoder->since_keyframe = UINT16_MAX;
+ }
+ 
+ uint8_t shtc1_encode(struct shtc1_encoder *encoder, uint16_t raw_t, uint16_t raw_rh,
+         uint8_t *buffer)
+ {
+     uint16_t interval = encoder->keyframe_interval;
+     uint8_t size;
+ 
+     if (encoder->since_keyframe == UINT16_MAX ||
+             (interval && encoder->since_keyframe + 1 >= interval)) {
+         buffer[0] = CODEC_KEYFRAME;
+         buffer[1] = raw_t >> 8;
+         buffer[2] = raw_t & 0xff;
+         buffer[3] = raw_rh >> 8;
+         buffer[4] = raw_rh & 0xff;
+         size = 5;
+         encoder->since_keyframe = 0;
+     } else {
+         /* the tag shift makes the zigzagged 16 bit difference 17 bits, 3 varint bytes */
+         size = shtc1_varint_put(buffer,
+                 shtc1_zigzag(shtc1_codec_delta(raw_t, encoder->last_t)) << 1);
+         size += shtc1_varint_put(&buffer[size],
+                 shtc1_zigzag(shtc1_codec_delta(raw_rh, encoder->last_rh)));
+         ++encoder->since_keyframe;
+     }
+ 
+     encoder->last_t = raw_t;
+     encoder->last_rh = raw_rh;
+     return size;
+ }
+ 
+ void shtc1_decoder_init(struct shtc1_decoder *decoder)
+ {
+     decoder->last_t = 0;
+     decoder->last_rh = 0;
+     decoder->synced = false;
+ }
+ 
+ uint8_t shtc1_decode(struct shtc1_decoder *decoder, const uint8_t *buffer,
+         uint16_t available, uint16_t *raw_t, uint16_t *raw_rh)
+ {
+     uint32_t tag, value;
+     uint8_t size, length;
+ 
+     size = shtc1_varint_get(buffer, available, &tag);
+     if (!size)
+         return 0;
+ 
+     if (tag == CODEC_KEYFRAME) {
+         if (available < size + 4)
+             return 0;
+         decoder->last_t = (uint16_t)((buffer[size] << 8) | buffer[size + 1]);
+         decoder->last_rh = (uint16_t)((buffer[size + 2] << 8) | buffer[size + 3]);
+         decoder->synced = true;
+         size += 4;
+     } else {
+         if ((tag & 1) || !decoder->synced)
+             return 0;
+         length = shtc1_varint_get(&buffer[size], available - size, &value);
+         if (!length)
+             return 0;
+         decoder->last_t = (uint16_t)(decoder->last_t + shtc1_unzigzag(tag >> 1));
+         decoder->last_rh = (uint16_t)(decoder->last_rh + shtc1_unzigzag(value));
+         size += length;
+     }
+ 
+     *raw_t = decoder->last_t;
+     *raw_rh = decoder->last_rh;
+     return size;
+ }
\ No newline at end of file
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 delta/varint sample stream codec
+ *
+ * This module compresses a stream of raw signals, as returned by
+ * shtc1_read_async_result_raw(), for low bandwidth links and storage. Every
+ * sample is either a keyframe with the full signals or the differences to the
+ * previous sample as zigzag varints, so slowly changing signals take 2 bytes
+ * per sample instead of 4. Keyframes are inserted at a fixed interval, after
+ * which a decoder that lost samples is back in sync.
+ *
+ * Sample encoding: a varint v; v = 1 is a keyframe followed by the temperature
+ * and humidity signals (2 bytes each, big endian), otherwise v = zigzag(dT) * 2
+ * is followed by the varint zigzag(dRH). Varints store 7 bits per byte, least
+ * significant group first, with the top bit set on all but the last byte.
+ */
+
+ #ifndef SHTC1_CODEC_H_
+ #define SHTC1_CODEC_H_
+ 
+ #include "shtc1.h"
+ 
+ /** largest encoded sample in bytes */
+ #define SHTC1_CODEC_MAX_SIZE 6
+ 
+ /** largest varint of the codec in bytes, values of up to 21 bits */
+ #define SHTC1_VARINT_MAX_SIZE 3
+ 
+ struct shtc1_encoder {
+     uint16_t last_t;
+     uint16_t last_rh;
+     /** samples between two keyframes, 0 for a keyframe only at the start */
+     uint16_t keyframe_interval;
+     /** samples since the last keyframe, the interval once a keyframe is due */
+     uint16_t since_keyframe;
+ };
+ 
+ struct shtc1_decoder {
+     uint16_t last_t;
+     uint16_t last_rh;
+     /** a keyframe has been decoded */
+     bool synced;
+ };
+ 
+ /**
+  * Maps a signed value to an unsigned one with small magnitudes first:
+  * 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+  */
+ static inline uint32_t shtc1_zigzag(int32_t value)
+ {
+     return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+ }
+ 
+ static inline int32_t shtc1_unzigzag(uint32_t value)
+ {
+     return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+ }
+ 
+ /**
+  * Writes a varint.
+  *
+  * @param buffer the destination, SHTC1_VARINT_MAX_SIZE bytes for values of up
+  *               to 21 bits
+  * @param value  the value
+  * @return       the number of bytes written
+  */
+ uint8_t shtc1_varint_put(uint8_t *buffer, uint32_t value);
+ 
+ /**
+  * Reads a varint of at most SHTC1_VARINT_MAX_SIZE bytes.
+  *
+  * @param buffer    the encoded data
+  * @param available the number of bytes in buffer
+  * @param value     receives the value
+  * @return          the number of bytes read, 0 if the varint is truncated or
+  *                  longer than SHTC1_VARINT_MAX_SIZE
+  */
+ uint8_t shtc1_varint_get(const uint8_t *buffer, uint16_t available, uint32_t *value);
+ 
+ /**
+  * Initializes an encoder. The first sample is encoded as a keyframe.
+  *
+  * @param encoder           the encoder to initialize
+  * @param keyframe_interval samples from one keyframe to the next, 0 to only
+  *                          start with a keyframe
+  */
+ void shtc1_encoder_init(struct shtc1_encoder *encoder, uint16_t keyframe_interval);
+ 
+ /**
+  * Encodes the next sample as a keyframe, e.g. at the start of a packet.
+  *
+  * @param encoder the encoder
+  */
+ void shtc1_encoder_force_keyframe(struct shtc1_encoder *encoder);
+ 
+ /**
+  * Encodes a sample.
+  *
+  * @param encoder the encoder
+  * @param raw_t   the temperature signal
+  * @param raw_rh  the humidity signal
+  * @param buffer  the destination, SHTC1_CODEC_MAX_SIZE bytes
+  * @return        the number of bytes written
+  */
+ uint8_t shtc1_encode(struct shtc1_encoder *encoder, uint16_t raw_t, uint16_t raw_rh,
+         uint8_t *buffer);
+ 
+ /**
+  * Initializes a decoder. Samples before the first keyframe are rejected.
+  *
+  * @param decoder the decoder to initialize
+  */
+ void shtc1_decoder_init(struct shtc1_decoder *decoder);
+ 
+ /**
+  * Decodes a sample.
+  *
+  * @param decoder   the decoder
+  * @param buffer    the encoded data
+  * @param available the number of bytes in buffer
+  * @param raw_t     receives the temperature signal
+  * @param raw_rh    receives the humidity signal
+  * @return          the number of bytes read, 0 if the sample is truncated,
+  *                  malformed or a difference without a preceding keyframe
+  */
+ uint8_t shtc1_decode(struct shtc1_decoder *decoder, const uint8_t *buffer,
+         uint16_t available, uint16_t *raw_t, uint16_t *raw_rh);
+ 
+ #endif /* SHTC1_CODEC_H_ */
\ No newline at end of file
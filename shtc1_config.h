@@ -0,0 +1,132 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 driver compile-time configuration
+ *
+ * All build options of the driver with their defaults. Define them on the
+ * compiler command line, or in a header named by SHTC1_CONFIG_FILE, e.g.
+ * -DSHTC1_CONFIG_FILE=\"conf_shtc1.h\". Options that disable a mode or an API
+ * remove the code and tables behind it, and a single mode folds the mode of
+ * the device handle to a constant on the measurement path.
+ */
+
+ #ifndef SHTC1_CONFIG_H_
+ #define SHTC1_CONFIG_H_
+ 
+ #ifdef SHTC1_CONFIG_FILE
+ #include SHTC1_CONFIG_FILE
+ #endif
+ 
+ /**
+  * Define SHTC1_CLOCK_STRETCHING if the I2C master tolerates the sensor holding
+  * SCL low for a full conversion (at least 14.4 ms, e.g. SERCOM with the SCL
+  * low timeout disabled and a sufficient buffer_timeout). The synchronous
+  * measurements then read back as soon as the sensor releases the bus instead
+  * of waiting for the worst case conversion time in software, and the command
+  * and the readout are issued as a single repeated start transaction. On a
+  * transport with lock operations the bus is released during the conversion
+  * regardless.
+  */
+ 
+ /**
+  * Define SHTC1_STATS to count the bus activity of every device handle, see
+  * shtc1_get_stats(). Without it the counters and the function do not exist.
+  */
+ 
+ /* measurement modes selectable with SHTC1_CONFIG_MODES */
+ #define SHTC1_MODES_LPM  0x01
+ #define SHTC1_MODES_HPM  0x02
+ #define SHTC1_MODES_BOTH (SHTC1_MODES_LPM | SHTC1_MODES_HPM)
+ 
+ /**
+  * The modes the driver supports. With a single mode every measurement uses
+  * it regardless of the mode of the device handle, and the functions of the
+  * other mode, e.g. shtc1_read_lpm_async(), do not exist.
+  */
+ #ifndef SHTC1_CONFIG_MODES
+ #define SHTC1_CONFIG_MODES SHTC1_MODES_BOTH
+ #endif
+ 
+ /** 1 to build the blocking measurements, shtc1_read_*_sync() */
+ #ifndef SHTC1_CONFIG_SYNC
+ #define SHTC1_CONFIG_SYNC 1
+ #endif
+ 
+ /**
+  * 1 to build the split measurements, shtc1_read_*_async(),
+  * shtc1_read_async_result*() and shtc1_poll_result(). Required by the
+  * scheduler, which fails to build without.
+  */
+ #ifndef SHTC1_CONFIG_ASYNC
+ #define SHTC1_CONFIG_ASYNC 1
+ #endif
+ 
+ /* CRC-8 implementations selectable with SHTC1_CRC_BACKEND */
+ /** bit by bit, no tables */
+ #define SHTC1_CRC_BITWISE 0
+ /** one lookup per nibble, 16 byte table */
+ #define SHTC1_CRC_NIBBLE  1
+ /** one lookup per byte, 256 byte table in flash */
+ #define SHTC1_CRC_TABLE   2
+ 
+ #ifndef SHTC1_CRC_BACKEND
+ #define SHTC1_CRC_BACKEND SHTC1_CRC_TABLE
+ #endif
+ 
+ /* units of the int results selectable with SHTC1_OUTPUT_FORMAT */
+ /** 1/1000 C and 1/1000 percent */
+ #define SHTC1_OUTPUT_MILLI 0
+ /** 1/100 C and 1/100 percent, saves the wider multiplications */
+ #define SHTC1_OUTPUT_CENTI 1
+ 
+ /**
+  * The unit of all int temperature and humidity results of the driver and of
+  * the scheduler, continuous sampling, adaptive and non-blocking modules, and
+  * of the thresholds compared with them. The raw signal conversions
+  * shtc1_raw_to_*(), shtc1_convert_batch() and the derived metrics keep the
+  * unit stated in their documentation.
+  */
+ #ifndef SHTC1_OUTPUT_FORMAT
+ #define SHTC1_OUTPUT_FORMAT SHTC1_OUTPUT_MILLI
+ #endif
+ 
+ /** results per degree Celsius and per percent relative humidity */
+ #if SHTC1_OUTPUT_FORMAT == SHTC1_OUTPUT_CENTI
+ #define SHTC1_OUTPUT_PER_UNIT 100
+ #else
+ #define SHTC1_OUTPUT_PER_UNIT 1000
+ #endif
+ 
+ /**
+  * Calls of the transport operations by shtc1.c. With a single transport in
+  * the build they can map to its functions directly, e.g.
+  * #define SHTC1_TRANSPORT_WRITE(transport, xfer) my_i2c_write(transport, xfer)
+  * which saves the indirect call and lets the compiler inline.
+  */
+ #ifndef SHTC1_TRANSPORT_WRITE
+ #define SHTC1_TRANSPORT_WRITE(transport, xfer) ((transport)->write((transport), (xfer)))
+ #endif
+ #ifndef SHTC1_TRANSPORT_READ
+ #define SHTC1_TRANSPORT_READ(transport, xfer) ((transport)->read((transport), (xfer)))
+ #endif
+ #ifndef SHTC1_TRANSPORT_DELAY_US
+ #define SHTC1_TRANSPORT_DELAY_US(transport, us) ((transport)->delay_us((transport), (us)))
+ #endif
+ 
+ #endif /* SHTC1_CONFIG_H_ */
\ No newline at end of file
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 continuous sampling implementation
+ *
+ * This module keeps a sensor measuring back to back using the non-blocking
+ * state machine of shtc1_async. Every result is stored with its start time
+ * in a single-producer/single-consumer ring buffer, filled from interrupt
+ * context and drained by the application in batches. With report-on-change
+ * only samples that differ from the last stored one by a threshold are kept.
+ * At a fixed rate the measurements are started from a periodic timer of the
+ * application instead.
+ */
+
+ #include "shtc1_continuous.h"
+ #include "shtc1_internal.h"
+ 
+ void shtc1_ring_init(struct shtc1_ring *ring)
+ {
+     ring->head = 0;
+     ring->tail = 0;
+     ring->dropped = 0;
+ }
+ 
+ bool shtc1_ring_push(struct shtc1_ring *ring, const struct shtc1_sample *sample)
+ {
+     uint16_t head = ring->head;
+ 
+     if ((uint16_t)(head - ring->tail) >= SHTC1_RING_SIZE) {
+         ring->dropped++;
+         return false;
+     }
+     ring->samples[head & (SHTC1_RING_SIZE - 1)] = *sample;
+     /* the sample must be visible before the consumer sees the new head */
+     SHTC1_MEMORY_BARRIER();
+     ring->head = head + 1;
+     return true;
+ }
+ 
+ uint16_t shtc1_ring_pop(struct shtc1_ring *ring, struct shtc1_sample *samples,
+         uint16_t max_samples)
+ {
+     uint16_t tail = ring->tail;
+     uint16_t available = ring->head - tail;
+     uint16_t count;
+ 
+     if (available > max_samples)
+         available = max_samples;
+     /* read the samples only after the head they were published with */
+     SHTC1_MEMORY_BARRIER();
+     for (count = 0; count < available; ++count)
+         samples[count] = ring->samples[(tail + count) & (SHTC1_RING_SIZE - 1)];
+     SHTC1_MEMORY_BARRIER();
+     ring->tail = tail + available;
+     return available;
+ }
+ 
+ static int shtc1_abs_diff(int a, int b)
+ {
+     return a > b ? a - b : b - a;
+ }
+ 
+ /* a threshold of 0 ignores its channel, a valid sample is stored if both are 0 */
+ static bool shtc1_continuous_changed(const struct shtc1_continuous *continuous,
+         const struct shtc1_sample *sample)
+ {
+     if (!continuous->reported || (!continuous->temp_hysteresis && !continuous->rh_hysteresis))
+         return true;
+     if (continuous->temp_hysteresis &&
+             shtc1_abs_diff(sample->temp, continuous->reported_temp) >= continuous->temp_hysteresis)
+         return true;
+     return continuous->rh_hysteresis &&
+             shtc1_abs_diff(sample->rh, continuous->reported_rh) >= continuous->rh_hysteresis;
+ }
+ 
+ /*
+  * Runs from the I2C interrupt and, when sampling periodically, from the timer
+  * interrupt as well, so the ring has two producers. The push and the
+  * hysteresis state are updated with interrupts masked.
+  */
+ static void shtc1_continuous_store(struct shtc1_continuous *continuous,
+         const struct shtc1_sample *sample)
+ {
+     uint32_t flags;
+     bool stored = false;
+ 
+     SHTC1_ENTER_CRITICAL(flags);
+     if (sample->status != STATUS_OK) {
+         continuous->reported = false;
+     } else if (!shtc1_continuous_changed(continuous, sample)) {
+         continuous->suppressed++;
+         SHTC1_EXIT_CRITICAL(flags);
+         return;
+     }
+     if (shtc1_ring_push(&continuous->ring, sample)) {
+         stored = true;
+         if (sample->status == STATUS_OK) {
+             continuous->reported = true;
+             continuous->reported_temp = sample->temp;
+             continuous->reported_rh = sample->rh;
+         }
+     }
+     SHTC1_EXIT_CRITICAL(flags);
+ 
+     if (stored && continuous->notify)
+         continuous->notify(continuous);
+ }
+ 
+ static void shtc1_continuous_store_status(struct shtc1_continuous *continuous,
+         enum status_code status)
+ {
+     struct shtc1_sample sample = {
+             .timestamp_us = shtc1_get_timestamp_us(continuous->async.dev),
+             .temp = 0,
+             .rh = 0,
+             .status = status,
+     };
+ 
+     shtc1_continuous_store(continuous, &sample);
+ }
+ 
+ static void shtc1_continuous_next(struct shtc1_continuous *continuous)
+ {
+     enum status_code status = shtc1_async_start(&continuous->async, continuous->mode);
+ 
+     if (status) {
+         /* at a fixed rate the next period tries again */
+         if (!continuous->period_us)
+             continuous->running = false;
+         shtc1_continuous_store_status(continuous, status);
+     }
+ }
+ 
+ static void shtc1_continuous_done(struct shtc1_async *async, enum status_code status,
+         int temp, int rh)
+ {
+     struct shtc1_continuous *continuous = async->user_data;
+     struct shtc1_sample sample = {
+             .timestamp_us = async->dev->last_start_us,
+             .temp = temp,
+             .rh = rh,
+             .status = status,
+     };
+ 
+     shtc1_continuous_store(continuous, &sample);
+     /* at a fixed rate the next measurement is started by the timer */
+     if (!continuous->running || continuous->period_us)
+         return;
+     /* restarting at once would retrigger a missing sensor forever */
+     if (status && status != STATUS_ERR_BAD_DATA) {
+         continuous->running = false;
+         return;
+     }
+     shtc1_continuous_next(continuous);
+ }
+ 
+ enum status_code shtc1_continuous_init(struct shtc1_continuous *continuous,
+         struct shtc1_dev *dev, shtc1_async_timer_t start_timer)
+ {
+     enum status_code ret = shtc1_async_init(&continuous->async, dev, start_timer,
+             shtc1_continuous_done);
+ 
+     if (ret)
+         return ret;
+     continuous->async.user_data = continuous;
+     continuous->mode = dev->mode;
+     continuous->running = false;
+     continuous->period_us = 0;
+     continuous->overruns = 0;
+     continuous->temp_hysteresis = 0;
+     continuous->rh_hysteresis = 0;
+     continuous->notify = NULL;
+     continuous->reported = false;
+     continuous->suppressed = 0;
+     shtc1_ring_init(&continuous->ring);
+     return STATUS_OK;
+ }
+ 
+ void shtc1_continuous_set_threshold(struct shtc1_continuous *continuous,
+         int temp_hysteresis, int rh_hysteresis)
+ {
+     continuous->reported = false;
+     continuous->temp_hysteresis = temp_hysteresis;
+     continuous->rh_hysteresis = rh_hysteresis;
+ }
+ 
+ void shtc1_continuous_set_notify(struct shtc1_continuous *continuous,
+         shtc1_continuous_notify_t notify)
+ {
+     continuous->notify = notify;
+ }
+ 
+ enum status_code shtc1_continuous_start(struct shtc1_continuous *continuous,
+         enum shtc1_mode mode)
+ {
+     enum status_code ret;
+ 
+     if (continuous->running)
+         return STATUS_BUSY;
+ 
+     continuous->mode = mode;
+     continuous->period_us = 0;
+     continuous->running = true;
+     ret = shtc1_async_start(&continuous->async, mode);
+     if (ret)
+         continuous->running = false;
+     return ret;
+ }
+ 
+ enum status_code shtc1_continuous_start_periodic(struct shtc1_continuous *continuous,
+         enum shtc1_mode mode, uint32_t period_us)
+ {
+     struct shtc1_dev *dev = continuous->async.dev;
+ 
+     if (continuous->running || shtc1_async_busy(&continuous->async))
+         return STATUS_BUSY;
+     if (period_us < shtc1_get_max_duration_us(mode) + shtc1_get_bus_time_us(dev))
+         return STATUS_ERR_INVALID_ARG;
+ 
+     continuous->mode = mode;
+     continuous->period_us = period_us;
+     continuous->overruns = 0;
+     continuous->running = true;
+     return STATUS_OK;
+ }
+ 
+ void shtc1_continuous_period_elapsed(struct shtc1_continuous *continuous)
+ {
+     if (!continuous->running || !continuous->period_us)
+         return;
+ 
+     if (shtc1_async_busy(&continuous->async)) {
+         continuous->overruns++;
+         shtc1_continuous_store_status(continuous, STATUS_ERR_OVERFLOW);
+         return;
+     }
+     shtc1_continuous_next(continuous);
+ }
+ 
+ void shtc1_continuous_stop(struct shtc1_continuous *continuous)
+ {
+     continuous->running = false;
+ }
+ 
+ uint16_t shtc1_continuous_read(struct shtc1_continuous *continuous,
+         struct shtc1_sample *samples, uint16_t max_samples)
+ {
+     return shtc1_ring_pop(&continuous->ring, samples, max_samples);
+ }
@@ -0,0 +1,242 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 continuous sampling interface
+ *
+ * This module keeps a sensor measuring back to back using the non-blocking
+ * state machine of shtc1_async. Every result is stored with its start time
+ * in a single-producer/single-consumer ring buffer, filled from interrupt
+ * context and drained by the application in batches. With report-on-change
+ * only samples that differ from the last stored one by a threshold are kept.
+ * At a fixed rate the measurements are started from a periodic timer of the
+ * application instead.
+ */
+
+ #ifndef SHTC1_CONTINUOUS_H_
+ #define SHTC1_CONTINUOUS_H_
+ 
+ #include "shtc1_async.h"
+ 
+ /* number of samples in the ring buffer, must be a power of two */
+ #ifndef SHTC1_RING_SIZE
+ #define SHTC1_RING_SIZE 16
+ #endif
+ 
+ #if (SHTC1_RING_SIZE & (SHTC1_RING_SIZE - 1)) != 0
+ #error SHTC1_RING_SIZE must be a power of two
+ #endif
+ 
+ struct shtc1_sample {
+     /** shtc1_get_timestamp_us() at the start of the measurement */
+     uint32_t timestamp_us;
+     /** temperature in 1/1000 C, 1/100 C with SHTC1_OUTPUT_CENTI */
+     int temp;
+     /** relative humidity in 1/1000 percent, 1/100 percent with SHTC1_OUTPUT_CENTI */
+     int rh;
+     /** STATUS_OK if temp and rh are valid, else an error code */
+     enum status_code status;
+ };
+ 
+ /**
+  * Lock-free ring buffer for one producer and one consumer. The head is only
+  * written by the producer, the tail only by the consumer. The continuous
+  * sampling pushes with interrupts masked, so the timer and the I2C interrupt
+  * may both store samples regardless of their priorities.
+  */
+ struct shtc1_ring {
+     struct shtc1_sample samples[SHTC1_RING_SIZE];
+     volatile uint16_t head;
+     volatile uint16_t tail;
+     /** samples discarded because the buffer was full */
+     volatile uint16_t dropped;
+ };
+ 
+ struct shtc1_continuous;
+ 
+ /**
+  * Called from interrupt context after a sample has been stored in the ring
+  * buffer, e.g. to wake the task draining it.
+  *
+  * @param continuous the context the sample was stored in
+  */
+ typedef void (*shtc1_continuous_notify_t)(struct shtc1_continuous *continuous);
+ 
+ struct shtc1_continuous {
+     struct shtc1_async async;
+     struct shtc1_ring ring;
+     enum shtc1_mode mode;
+     volatile bool running;
+     /** the sampling period, 0 when measuring back to back */
+     uint32_t period_us;
+     /** periods that elapsed while the previous measurement was in flight */
+     volatile uint16_t overruns;
+ 
+     /** minimum temperature change for a sample to be stored, in the unit of temp */
+     int temp_hysteresis;
+     /** minimum humidity change for a sample to be stored, in the unit of rh */
+     int rh_hysteresis;
+     shtc1_continuous_notify_t notify;
+     /** the last stored sample is valid and the reference for the thresholds */
+     bool reported;
+     int reported_temp;
+     int reported_rh;
+     /** valid samples discarded because they were within the thresholds */
+     volatile uint16_t suppressed;
+ };
+ 
+ /**
+  * Empties a ring buffer.
+  *
+  * @param ring the ring buffer
+  */
+ void shtc1_ring_init(struct shtc1_ring *ring);
+ 
+ /**
+  * Adds a sample to a ring buffer, never blocks. If the buffer is full the
+  * sample is discarded and counted in dropped.
+  *
+  * @param ring   the ring buffer
+  * @param sample the sample to add
+  * @return       true if the sample was stored
+  */
+ bool shtc1_ring_push(struct shtc1_ring *ring, const struct shtc1_sample *sample);
+ 
+ /**
+  * Removes up to max_samples of the oldest samples from a ring buffer.
+  *
+  * @param ring        the ring buffer
+  * @param samples     the destination for the samples
+  * @param max_samples the capacity of samples
+  * @return            the number of samples copied
+  */
+ uint16_t shtc1_ring_pop(struct shtc1_ring *ring, struct shtc1_sample *samples,
+         uint16_t max_samples);
+ 
+ /**
+  * Initializes continuous sampling on a device, see shtc1_async_init(). The
+  * start_timer callback is called with &continuous->async and the application
+  * calls shtc1_async_timer_expired() with it when the timer expires.
+  *
+  * @param continuous  the context to initialize
+  * @param dev         the device handle
+  * @param start_timer arms the conversion timer of the application
+  * @return            STATUS_OK if the context was initialized, else an error
+  *                    code.
+  */
+ enum status_code shtc1_continuous_init(struct shtc1_continuous *continuous,
+         struct shtc1_dev *dev, shtc1_async_timer_t start_timer);
+ 
+ /**
+  * Enables report-on-change: a valid sample is only stored when its
+  * temperature or humidity differs from the last stored sample by at least
+  * the given amount, all others are counted in suppressed. Samples with an
+  * error status are always stored, and the first valid sample after one is
+  * stored as the new reference. A threshold of 0 ignores its channel, e.g.
+  * (100, 0) reports temperature changes only. With both thresholds 0, the
+  * default, every sample is stored. May be called while sampling, the next
+  * sample is stored as the new reference.
+  *
+  * @param continuous      the context
+  * @param temp_hysteresis the threshold for the temperature in 1/1000 C,
+  *                        1/100 C with SHTC1_OUTPUT_CENTI
+  * @param rh_hysteresis   the threshold for the humidity in 1/1000 percent,
+  *                        1/100 percent with SHTC1_OUTPUT_CENTI
+  */
+ void shtc1_continuous_set_threshold(struct shtc1_continuous *continuous,
+         int temp_hysteresis, int rh_hysteresis);
+ 
+ /**
+  * Sets a callback for every sample stored in the ring buffer. Suppressed
+  * samples do not call it, so with report-on-change the application is only
+  * woken when the readings have moved.
+  *
+  * @param continuous the context
+  * @param notify     the callback, NULL for none
+  */
+ void shtc1_continuous_set_notify(struct shtc1_continuous *continuous,
+         shtc1_continuous_notify_t notify);
+ 
+ /**
+  * Starts measuring back to back. The next measurement is started from the
+  * completion of the previous readout. A result with a checksum error is
+  * stored as a sample with STATUS_ERR_BAD_DATA and sampling continues. If the
+  * sensor does not respond or the bus fails, a sample with the error status
+  * is stored and sampling stops.
+  *
+  * @param continuous the context
+  * @param mode       the measurement mode
+  * @return           STATUS_OK if sampling was started, else an error code.
+  */
+ enum status_code shtc1_continuous_start(struct shtc1_continuous *continuous,
+         enum shtc1_mode mode);
+ 
+ /**
+  * Starts sampling at a fixed rate. Measurements are not started by the
+  * driver but by the application calling shtc1_continuous_period_elapsed()
+  * from a periodic hardware timer, e.g. an RTC or TC compare interrupt, so
+  * every measurement starts on a period boundary without drift and the
+  * jitter is only the interrupt latency. The start time is recorded in each
+  * sample.
+  *
+  * @param continuous the context
+  * @param mode       the measurement mode
+  * @param period_us  the period of the timer of the application
+  * @return           STATUS_OK if sampling was enabled, STATUS_BUSY if sampling
+  *                   is already running, STATUS_ERR_INVALID_ARG if the period
+  *                   is shorter than the conversion plus the bus time of a
+  *                   measurement, see shtc1_get_bus_time_us().
+  */
+ enum status_code shtc1_continuous_start_periodic(struct shtc1_continuous *continuous,
+         enum shtc1_mode mode, uint32_t period_us);
+ 
+ /**
+  * Starts the measurement of a period, must be called from the periodic timer
+  * of the application after shtc1_continuous_start_periodic(). If the
+  * measurement of the previous period is still in flight, no measurement is
+  * started, the overrun is counted in overruns and a sample with
+  * STATUS_ERR_OVERFLOW is stored in its place. A measurement that can not be
+  * started is stored as a sample with the error status, and sampling
+  * continues with the next period. The timer interrupt may preempt the I2C
+  * interrupt or be preempted by it, samples are stored in a critical section,
+  * see SHTC1_ENTER_CRITICAL.
+  *
+  * @param continuous the context
+  */
+ void shtc1_continuous_period_elapsed(struct shtc1_continuous *continuous);
+ 
+ /**
+  * Stops sampling after the measurement in flight has completed.
+  *
+  * @param continuous the context
+  */
+ void shtc1_continuous_stop(struct shtc1_continuous *continuous);
+ 
+ /**
+  * Drains samples taken since the last call, see shtc1_ring_pop().
+  *
+  * @param continuous  the context
+  * @param samples     the destination for the samples
+  * @param max_samples the capacity of samples
+  * @return            the number of samples copied
+  */
+ uint16_t shtc1_continuous_read(struct shtc1_continuous *continuous,
+         struct shtc1_sample *samples, uint16_t max_samples);
+ 
+ #endif /* SHTC1_CONTINUOUS_H_ */
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 derived humidity metrics implementation
+ *
+ * This module calculates dew point, absolute humidity and heat index in
+ * integer arithmetic, see shtc1_derived.h. Intermediate values are Q16 fixed
+ * point, products are formed in 64 bits.
+ */
+
+ #include "shtc1_derived.h"
+ 
+ /* log2(1 + i / 32) in Q16 */
+ static const uint16_t LOG2_TABLE[33] = {
+         0, 2909, 5732, 8473, 11136, 13727, 16248, 18704,
+         21098, 23433, 25711, 27936, 30109, 32234, 34312, 36346,
+         38336, 40286, 42196, 44068, 45904, 47705, 49472, 51207,
+         52911, 54584, 56229, 57845, 59434, 60997, 62534, 64047,
+         65535
+ };
+ 
+ /* 2^(i / 32) in Q16 */
+ static const uint32_t EXP2_TABLE[33] = {
+         65536, 66971, 68438, 69936, 71468, 73032, 74632, 76266,
+         77936, 79642, 81386, 83169, 84990, 86851, 88752, 90696,
+         92682, 94711, 96785, 98905, 101070, 103283, 105545, 107856,
+         110218, 112631, 115098, 117618, 120194, 122825, 125515, 128263,
+         131072
+ };
+ 
+ /* Magnus parameters: b in Q16, c in 1/1000 C */
+ static const int32_t MAGNUS_B_Q16 = 1154744;
+ static const int32_t MAGNUS_C = 243120;
+ /* ln(2), log2(e) and log2(100000) in Q16 */
+ static const int32_t LN2_Q16 = 45426;
+ static const int32_t LOG2E_Q16 = 94548;
+ static const int32_t LOG2_100000_Q16 = 1088529;
+ 
+ /* log2 of a positive integer in Q16 */
+ static int32_t shtc1_log2_q16(uint32_t value)
+ {
+     uint32_t mantissa;
+     uint8_t msb = 31;
+     uint8_t index;
+     uint16_t frac;
+ 
+     while (!(value & ((uint32_t)1 << msb)))
+         --msb;
+     /* normalize to 1.16 fixed point in [1, 2) */
+     mantissa = msb >= 16 ? value >> (msb - 16) : value << (16 - msb);
+     index = (mantissa >> 11) & 0x1f;
+     frac = mantissa & 0x7ff;
+     return ((int32_t)msb << 16) + LOG2_TABLE[index] +
+             (int32_t)(((LOG2_TABLE[index + 1] - LOG2_TABLE[index]) * (uint32_t)frac) >> 11);
+ }
+ 
+ /* 2^x for x in Q16, in Q16 */
+ static uint32_t shtc1_exp2_q16(int32_t x)
+ {
+     int32_t integer = x >> 16;
+     uint32_t frac = x & 0xffff;
+     uint8_t index = frac >> 11;
+     uint32_t value;
+ 
+     value = EXP2_TABLE[index] +
+             (((EXP2_TABLE[index + 1] - EXP2_TABLE[index]) * (frac & 0x7ff)) >> 11);
+     if (integer >= 0)
+         return integer < 15 ? value << integer : UINT32_MAX;
+     return integer > -17 ? value >> -integer : 0;
+ }
+ 
+ /* b * T / (c + T) of the Magnus formula in Q16 */
+ static int32_t shtc1_magnus_term(int32_t temp)
+ {
+     return (int32_t)((int64_t)MAGNUS_B_Q16 * temp / (MAGNUS_C + temp));
+ }
+ 
+ int32_t shtc1_dew_point(int32_t temp, int32_t rh)
+ {
+     int32_t gamma;
+ 
+     if (rh <= 0)
+         rh = 1;
+     /* ln(RH / 100 %) + b * T / (c + T) */
+     gamma = (int32_t)(((int64_t)(shtc1_log2_q16(rh) - LOG2_100000_Q16) * LN2_Q16) >> 16) +
+             shtc1_magnus_term(temp);
+     return (int32_t)((int64_t)MAGNUS_C * gamma / (MAGNUS_B_Q16 - gamma));
+ }
+ 
+ int32_t shtc1_absolute_humidity(int32_t temp, int32_t rh)
+ {
+     /* saturation vapour pressure relative to 6.112 hPa: e^(b * T / (c + T)) */
+     uint32_t pressure = shtc1_exp2_q16(
+             (int32_t)(((int64_t)shtc1_magnus_term(temp) * LOG2E_Q16) >> 16));
+     int64_t product;
+ 
+     if (rh <= 0)
+         return 0;
+     /**
+      * AH = 216.7 g K / (m^3 hPa) * RH / 100 % * 6.112 hPa * pressure / (273.15 C + T)
+      *    = 13244.7 mg K / m^3 * RH[1/1000 %] * pressure / T[1/1000 K]
+      */
+     product = ((int64_t)rh * pressure) >> 16;
+     return (int32_t)(product * 132447 / ((int64_t)(273150 + temp) * 10));
+ }
+ 
+ static uint32_t shtc1_isqrt(uint32_t value)
+ {
+     uint32_t root = 0;
+     uint32_t bit = (uint32_t)1 << 30;
+ 
+     while (bit > value)
+         bit >>= 2;
+     while (bit) {
+         if (value >= root + bit) {
+             value -= root + bit;
+             root = (root >> 1) + bit;
+         } else {
+             root >>= 1;
+         }
+         bit >>= 2;
+     }
+     return root;
+ }
+ 
+ int32_t shtc1_heat_index(int32_t temp, int32_t rh)
+ {
+     /* the regression is defined in F, evaluated in 1/100 F and 1/100 percent */
+     int64_t t = ((int64_t)temp * 9 / 5 + 32000) / 10;
+     int64_t r = rh / 10;
+     int64_t t2 = t * t;
+     int64_t r2 = r * r;
+     int64_t index;
+ 
+     /* Steadman: 0.5 * (T + 61 + (T - 68) * 1.2 + RH * 0.094) */
+     index = (t + 6100 + (t - 6800) * 12 / 10 + r * 94 / 1000) / 2;
+ 
+     if (index + t >= 2 * 8000) {
+         /* Rothfusz, coefficients scaled by 10^8 */
+         index = -423790000000LL
+                 + 204901523LL * t
+                 + 1014333127LL * r
+                 - 22475541LL * (t * r / 100)
+                 - 683783LL * (t2 / 100)
+                 - 5481717LL * (r2 / 100)
+                 + 122874LL * (t2 * r / 10000)
+                 + 85282LL * (t * r2 / 10000)
+                 - 199LL * (t2 * r2 / 1000000);
+         index /= 100000000;
+ 
+         if (r < 1300 && t >= 8000 && t <= 11200) {
+             /* ((13 - RH) / 4) * sqrt((17 - |T - 95|) / 17) */
+             int64_t offset = t > 9500 ? t - 9500 : 9500 - t;
+ 
+             index -= (1300 - r) * shtc1_isqrt((uint32_t)((1700 - offset) * 100 / 17)) / 400;
+         } else if (r > 8500 && t >= 8000 && t <= 8700) {
+             /* ((RH - 85) / 10) * ((87 - T) / 5) */
+             index += (r - 8500) * (8700 - t) / 5000;
+         }
+     }
+ 
+     /* back to 1/1000 C */
+     return (int32_t)((index - 3200) * 50 / 9);
+ }
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 derived humidity metrics
+ *
+ * This module calculates dew point, absolute humidity and heat index from
+ * results in 1/1000 C and 1/1000 percent, in integer arithmetic only. The
+ * logarithm and exponential function of the Magnus formula are approximated
+ * by 33 entry tables with linear interpolation, which keeps the error far
+ * below the accuracy of the sensor, at a small fraction of the cost of the
+ * float functions on cores without FPU. Raw signals are converted with
+ * shtc1_raw_to_milli_temp() and shtc1_raw_to_milli_rh() first. The units do
+ * not follow SHTC1_OUTPUT_FORMAT, results of a SHTC1_OUTPUT_CENTI build are
+ * multiplied by 10 first.
+ */
+
+ #ifndef SHTC1_DERIVED_H_
+ #define SHTC1_DERIVED_H_
+ 
+ #include "shtc1.h"
+ 
+ /**
+  * Calculates the dew point with the Magnus formula and the parameters of
+  * the Sensirion application note (17.62, 243.12 C), valid from -45 C to
+  * 60 C.
+  *
+  * @param temp the temperature in 1/1000 C
+  * @param rh   the relative humidity in 1/1000 percent, above 0
+  * @return     the dew point in 1/1000 C
+  */
+ int32_t shtc1_dew_point(int32_t temp, int32_t rh);
+ 
+ /**
+  * Calculates the absolute humidity, the mass of water vapour per volume of
+  * air, from the Magnus saturation vapour pressure.
+  *
+  * @param temp the temperature in 1/1000 C
+  * @param rh   the relative humidity in 1/1000 percent
+  * @return     the absolute humidity in mg/m^3
+  */
+ int32_t shtc1_absolute_humidity(int32_t temp, int32_t rh);
+ 
+ /**
+  * Calculates the heat index, the apparent temperature, with the algorithm of
+  * the US National Weather Service: the Steadman approximation at low values
+  * and the Rothfusz regression with its adjustments above 80 F.
+  *
+  * @param temp the temperature in 1/1000 C
+  * @param rh   the relative humidity in 1/1000 percent
+  * @return     the heat index in 1/1000 C
+  */
+ int32_t shtc1_heat_index(int32_t temp, int32_t rh);
+ 
+ #endif /* SHTC1_DERIVED_H_ */
\ No newline at end of file
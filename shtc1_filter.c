@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 raw signal filters implementation
+ *
+ * This module aggregates results on the raw sensor signals, see
+ * shtc1_filter.h. All sums fit 32 bits for windows of up to 65535 samples.
+ */
+
+ #include "shtc1_filter.h"
+ 
+ /* rounded division of a window sum */
+ static inline uint16_t shtc1_filter_mean(uint32_t sum, uint16_t count)
+ {
+     return (uint16_t)((sum + count / 2) / count);
+ }
+ 
+ void shtc1_boxcar_init(struct shtc1_boxcar *boxcar, uint16_t length)
+ {
+     boxcar->sum_t = 0;
+     boxcar->sum_rh = 0;
+     boxcar->count = 0;
+     boxcar->length = length ? length : 1;
+ }
+ 
+ bool shtc1_boxcar_push(struct shtc1_boxcar *boxcar, uint16_t raw_t, uint16_t raw_rh,
+         uint16_t *out_t, uint16_t *out_rh)
+ {
+     boxcar->sum_t += raw_t;
+     boxcar->sum_rh += raw_rh;
+     if (++boxcar->count < boxcar->length)
+         return false;
+ 
+     *out_t = shtc1_filter_mean(boxcar->sum_t, boxcar->count);
+     *out_rh = shtc1_filter_mean(boxcar->sum_rh, boxcar->count);
+     boxcar->sum_t = 0;
+     boxcar->sum_rh = 0;
+     boxcar->count = 0;
+     return true;
+ }
+ 
+ void shtc1_ema_init(struct shtc1_ema *ema, uint8_t shift)
+ {
+     ema->acc_t = 0;
+     ema->acc_rh = 0;
+     ema->shift = shift > 15 ? 15 : shift;
+     ema->primed = false;
+ }
+ 
+ void shtc1_ema_push(struct shtc1_ema *ema, uint16_t raw_t, uint16_t raw_rh,
+         uint16_t *out_t, uint16_t *out_rh)
+ {
+     uint8_t shift = ema->shift;
+     uint32_t round = shift ? (uint32_t)1 << (shift - 1) : 0;
+ 
+     if (!ema->primed) {
+         ema->acc_t = (uint32_t)raw_t << shift;
+         ema->acc_rh = (uint32_t)raw_rh << shift;
+         ema->primed = true;
+     } else {
+         /* acc += raw - acc / 2^shift, at most 2^31 */
+         ema->acc_t += raw_t - ((ema->acc_t + round) >> shift);
+         ema->acc_rh += raw_rh - ((ema->acc_rh + round) >> shift);
+     }
+ 
+     *out_t = (uint16_t)((ema->acc_t + round) >> shift);
+     *out_rh = (uint16_t)((ema->acc_rh + round) >> shift);
+ }
+ 
+ void shtc1_window_init(struct shtc1_window *window, uint16_t length)
+ {
+     window->sum_t = 0;
+     window->sum_rh = 0;
+     window->count = 0;
+     window->length = length ? length : 1;
+ }
+ 
+ bool shtc1_window_push(struct shtc1_window *window, uint16_t raw_t, uint16_t raw_rh,
+         struct shtc1_summary *summary)
+ {
+     struct shtc1_summary *current = &window->summary;
+ 
+     if (!window->count) {
+         current->min_t = current->max_t = raw_t;
+         current->min_rh = current->max_rh = raw_rh;
+     } else {
+         if (raw_t < current->min_t)
+             current->min_t = raw_t;
+         if (raw_t > current->max_t)
+             current->max_t = raw_t;
+         if (raw_rh < current->min_rh)
+             current->min_rh = raw_rh;
+         if (raw_rh > current->max_rh)
+             current->max_rh = raw_rh;
+     }
+     window->sum_t += raw_t;
+     window->sum_rh += raw_rh;
+     if (++window->count < window->length)
+         return false;
+ 
+     current->mean_t = shtc1_filter_mean(window->sum_t, window->count);
+     current->mean_rh = shtc1_filter_mean(window->sum_rh, window->count);
+     *summary = *current;
+     window->sum_t = 0;
+     window->sum_rh = 0;
+     window->count = 0;
+     return true;
+ }
\ No newline at end of file
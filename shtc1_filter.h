@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 raw signal filters
+ *
+ * This module aggregates results on the raw sensor signals as returned by
+ * shtc1_read_async_result_raw(), before conversion: a decimating N-sample
+ * boxcar average, a fixed point exponential moving average and min/max/mean
+ * summaries per window. At high sample rates only one value per window then
+ * needs to be converted with shtc1_raw_to_*() and transmitted.
+ */
+
+ #ifndef SHTC1_FILTER_H_
+ #define SHTC1_FILTER_H_
+ 
+ #include "shtc1.h"
+ 
+ /**
+  * Decimating average over a window of samples.
+  */
+ struct shtc1_boxcar {
+     uint32_t sum_t;
+     uint32_t sum_rh;
+     uint16_t count;
+     /** samples per window */
+     uint16_t length;
+ };
+ 
+ /**
+  * Exponential moving average with a smoothing factor of 2^-shift.
+  */
+ struct shtc1_ema {
+     /** filtered signals scaled by 2^shift */
+     uint32_t acc_t;
+     uint32_t acc_rh;
+     uint8_t shift;
+     bool primed;
+ };
+ 
+ /**
+  * Summary of the raw signals of a window.
+  */
+ struct shtc1_summary {
+     uint16_t min_t;
+     uint16_t max_t;
+     uint16_t mean_t;
+     uint16_t min_rh;
+     uint16_t max_rh;
+     uint16_t mean_rh;
+ };
+ 
+ /**
+  * Min/max/mean summary over a window of samples.
+  */
+ struct shtc1_window {
+     struct shtc1_summary summary;
+     uint32_t sum_t;
+     uint32_t sum_rh;
+     uint16_t count;
+     /** samples per window */
+     uint16_t length;
+ };
+ 
+ /**
+  * Initializes a boxcar average.
+  *
+  * @param boxcar the filter to initialize
+  * @param length the number of samples per output, at least 1
+  */
+ void shtc1_boxcar_init(struct shtc1_boxcar *boxcar, uint16_t length);
+ 
+ /**
+  * Adds a sample to a boxcar average.
+  *
+  * @param boxcar the filter
+  * @param raw_t  the temperature signal
+  * @param raw_rh the humidity signal
+  * @param out_t  receives the averaged temperature signal of a complete window
+  * @param out_rh receives the averaged humidity signal of a complete window
+  * @return       true if the sample completed a window and the outputs are set
+  */
+ bool shtc1_boxcar_push(struct shtc1_boxcar *boxcar, uint16_t raw_t, uint16_t raw_rh,
+         uint16_t *out_t, uint16_t *out_rh);
+ 
+ /**
+  * Initializes an exponential moving average. The first sample sets the
+  * filter state.
+  *
+  * @param ema   the filter to initialize
+  * @param shift the smoothing factor as power of two, 0 to 15; a step settles
+  *              to 1/e after about 2^shift samples
+  */
+ void shtc1_ema_init(struct shtc1_ema *ema, uint8_t shift);
+ 
+ /**
+  * Adds a sample to an exponential moving average.
+  *
+  * @param ema    the filter
+  * @param raw_t  the temperature signal
+  * @param raw_rh the humidity signal
+  * @param out_t  receives the filtered temperature signal
+  * @param out_rh receives the filtered humidity signal
+  */
+ void shtc1_ema_push(struct shtc1_ema *ema, uint16_t raw_t, uint16_t raw_rh,
+         uint16_t *out_t, uint16_t *out_rh);
+ 
+ /**
+  * Initializes a min/max/mean summary.
+  *
+  * @param window the filter to initialize
+  * @param length the number of samples per summary, at least 1
+  */
+ void shtc1_window_init(struct shtc1_window *window, uint16_t length);
+ 
+ /**
+  * Adds a sample to a min/max/mean summary.
+  *
+  * @param window  the filter
+  * @param raw_t   the temperature signal
+  * @param raw_rh  the humidity signal
+  * @param summary receives the summary of a complete window
+  * @return        true if the sample completed a window and summary is set
+  */
+ bool shtc1_window_push(struct shtc1_window *window, uint16_t raw_t, uint16_t raw_rh,
+         struct shtc1_summary *summary);
+ 
+ #endif /* SHTC1_FILTER_H_ */
\ No newline at end of file
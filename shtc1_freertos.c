@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 transport for FreeRTOS
+ *
+ * This module wraps the transport of a bus shared between FreeRTOS tasks.
+ * Transfers are forwarded to the transport of the bus, the lock operations
+ * take its mutex and waits of a tick or longer block the calling task.
+ */
+
+ #include "shtc1_freertos.h"
+ #include "task.h"
+ 
+ static enum status_code shtc1_freertos_write(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     return rtos->bus->write(rtos->bus, xfer);
+ }
+ 
+ static enum status_code shtc1_freertos_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     return rtos->bus->read(rtos->bus, xfer);
+ }
+ 
+ static enum status_code shtc1_freertos_write_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *write, const struct shtc1_xfer *read)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     return rtos->bus->write_read(rtos->bus, write, read);
+ }
+ 
+ static void shtc1_freertos_delay_us(struct shtc1_transport *transport, uint32_t us)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+     uint64_t ticks = ((uint64_t)us * configTICK_RATE_HZ + 999999) / 1000000;
+ 
+     /* the scheduler can not wait for less than a tick */
+     if ((uint64_t)us * configTICK_RATE_HZ < 1000000 ||
+             xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+         rtos->bus->delay_us(rtos->bus, us);
+         return;
+     }
+     /* the next tick may follow immediately, wait one more */
+     vTaskDelay((TickType_t)(ticks + 1));
+ }
+ 
+ static uint32_t shtc1_freertos_timestamp_us(struct shtc1_transport *transport)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     return rtos->bus->timestamp_us(rtos->bus);
+ }
+ 
+ static enum status_code shtc1_freertos_recover(struct shtc1_transport *transport)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     return rtos->bus->recover(rtos->bus);
+ }
+ 
+ static enum status_code shtc1_freertos_lock(struct shtc1_transport *transport)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     if (xSemaphoreTake(rtos->mutex, rtos->lock_timeout) != pdTRUE)
+         return STATUS_BUSY;
+     return STATUS_OK;
+ }
+ 
+ static void shtc1_freertos_unlock(struct shtc1_transport *transport)
+ {
+     struct shtc1_freertos *rtos = (struct shtc1_freertos *)transport;
+ 
+     xSemaphoreGive(rtos->mutex);
+ }
+ 
+ enum status_code shtc1_freertos_init(struct shtc1_freertos *rtos,
+         struct shtc1_transport *bus, SemaphoreHandle_t mutex, TickType_t lock_timeout)
+ {
+     if (!mutex)
+         mutex = xSemaphoreCreateMutex();
+     if (!mutex)
+         return STATUS_ERR_NO_MEMORY;
+ 
+     rtos->bus = bus;
+     rtos->mutex = mutex;
+     rtos->lock_timeout = lock_timeout;
+ 
+     rtos->transport.write = shtc1_freertos_write;
+     rtos->transport.read = shtc1_freertos_read;
+     rtos->transport.write_read = bus->write_read ? shtc1_freertos_write_read : NULL;
+     rtos->transport.delay_us = shtc1_freertos_delay_us;
+     rtos->transport.timestamp_us = bus->timestamp_us ? shtc1_freertos_timestamp_us : NULL;
+     rtos->transport.recover = bus->recover ? shtc1_freertos_recover : NULL;
+     rtos->transport.lock = shtc1_freertos_lock;
+     rtos->transport.unlock = shtc1_freertos_unlock;
+     rtos->transport.write_async = NULL;
+     rtos->transport.read_async = NULL;
+     return STATUS_OK;
+ }
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 transport for FreeRTOS
+ *
+ * This module wraps the transport of a bus shared between FreeRTOS tasks.
+ * The driver takes the mutex of the bus only for the command write and the
+ * readout of a measurement and releases it for the conversion, during which
+ * the calling task is blocked instead of busy waiting, so other devices on
+ * the bus and other tasks can run.
+ */
+
+ #ifndef SHTC1_FREERTOS_H_
+ #define SHTC1_FREERTOS_H_
+ 
+ #include "shtc1_transport.h"
+ #include "FreeRTOS.h"
+ #include "semphr.h"
+ 
+ struct shtc1_freertos {
+     struct shtc1_transport transport;
+     /** the transport of the bus, e.g. the transport of a struct shtc1_asf */
+     struct shtc1_transport *bus;
+     /** the mutex of the bus, shared with the drivers of the other devices */
+     SemaphoreHandle_t mutex;
+     /** the longest time to wait for the mutex */
+     TickType_t lock_timeout;
+ };
+ 
+ /**
+  * Initializes a transport that serializes the accesses of all tasks to a
+  * bus. Every transfer of the driver must go through this transport, and the
+  * drivers of other devices on the bus must take the same mutex. The
+  * non-blocking operations are not provided since they can not take a mutex
+  * from interrupt context.
+  *
+  * @param rtos         the transport to initialize
+  * @param bus          the initialized transport of the bus
+  * @param mutex        the mutex of the bus, or NULL to create one
+  * @param lock_timeout the longest time to wait for the bus, portMAX_DELAY to
+  *                     wait forever. A transfer that does not get the bus in
+  *                     time fails with STATUS_BUSY.
+  * @return             STATUS_OK if the transport was initialized,
+  *                     STATUS_ERR_NO_MEMORY if the mutex can not be created
+  */
+ enum status_code shtc1_freertos_init(struct shtc1_freertos *rtos,
+         struct shtc1_transport *bus, SemaphoreHandle_t mutex, TickType_t lock_timeout);
+ 
+ #endif /* SHTC1_FREERTOS_H_ */
\ No newline at end of file
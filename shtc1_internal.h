@@ -0,0 +1,100 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 driver internals
+ *
+ * Definitions shared between the driver modules. Not part of the public
+ * interface.
+ */
+
+ #ifndef SHTC1_INTERNAL_H_
+ #define SHTC1_INTERNAL_H_
+ 
+ #include "shtc1.h"
+ 
+ extern const uint8_t CMD_MEASURE_LPM_CS[];
+ extern const uint8_t CMD_MEASURE_LPM[];
+ extern const uint8_t CMD_MEASURE_HPM_CS[];
+ extern const uint8_t CMD_MEASURE_HPM[];
+ extern const uint8_t CMD_SOFT_RESET[];
+ extern const uint8_t CMD_READ_ID_REG[];
+ extern const uint8_t CMD_SLEEP[];
+ extern const uint8_t CMD_WAKEUP[];
+ extern const size_t COMMAND_SIZE;
+ extern const uint16_t SHTC1_ADDRESS;
+ 
+ /* measurement commands without clock stretching, indexed by enum shtc1_mode */
+ extern const uint8_t *const CMD_MEASURE[];
+ 
+ /* the mode a measurement is taken in, a constant if SHTC1_CONFIG_MODES selects one */
+ static inline enum shtc1_mode shtc1_effective_mode(enum shtc1_mode mode)
+ {
+ #if SHTC1_CONFIG_MODES == SHTC1_MODES_LPM
+     (void)mode;
+     return SHTC1_MODE_LPM;
+ #elif SHTC1_CONFIG_MODES == SHTC1_MODES_HPM
+     (void)mode;
+     return SHTC1_MODE_HPM;
+ #else
+     return mode;
+ #endif
+ }
+ 
+ /* orders memory accesses between interrupt and thread context, a DMB on Cortex-M */
+ #ifndef SHTC1_MEMORY_BARRIER
+ #define SHTC1_MEMORY_BARRIER() __sync_synchronize()
+ #endif
+ 
+ /**
+  * Masks interrupts around a short sequence that more than one interrupt may
+  * run, by default PRIMASK on Cortex-M. Cortex-A and AArch64 have no PRIMASK,
+  * like other hosts, e.g. Linux, they run the driver from a single context and
+  * need no masking. Override both for targets where the driver runs in more than
+  * one interrupt context, e.g. with the ASF cpu_irq_save() and
+  * cpu_irq_restore().
+  */
+ #ifndef SHTC1_ENTER_CRITICAL
+ #if defined(__GNUC__) && defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+ #define SHTC1_ENTER_CRITICAL(flags) \
+     __asm__ volatile ("mrs %0, primask\n\tcpsid i" : "=r" (flags) : : "memory")
+ #define SHTC1_EXIT_CRITICAL(flags) \
+     __asm__ volatile ("msr primask, %0" : : "r" (flags) : "memory")
+ #else
+ #define SHTC1_ENTER_CRITICAL(flags) ((void)(flags = 0))
+ #define SHTC1_EXIT_CRITICAL(flags) ((void)(flags))
+ #endif
+ #endif
+ 
+ /* sensor signals of a measurement frame */
+ static inline uint16_t shtc1_frame_raw_t(const uint8_t *frame)
+ {
+     return (uint16_t)((frame[0] << 8) | frame[1]);
+ }
+ 
+ static inline uint16_t shtc1_frame_raw_rh(const uint8_t *frame)
+ {
+     return (uint16_t)((frame[3] << 8) | frame[4]);
+ }
+ 
+ /**
+  * Converts a CRC checked measurement frame to the unit of SHTC1_OUTPUT_FORMAT.
+  */
+ void shtc1_convert_frame(const uint8_t *frame, int *temp, int *rh);
+ 
+ #endif /* SHTC1_INTERNAL_H_ */
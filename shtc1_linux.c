@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 transport for Linux i2c-dev implementation
+ *
+ * This module implements the driver transport on a /dev/i2c-N adapter, see
+ * shtc1_linux.h.
+ */
+
+ /* struct timespec, nanosleep() and clock_gettime() */
+ #define _POSIX_C_SOURCE 199309L
+ 
+ #include <errno.h>
+ #include <fcntl.h>
+ #include <time.h>
+ #include <unistd.h>
+ #include <sys/ioctl.h>
+ #include <linux/i2c.h>
+ #include <linux/i2c-dev.h>
+ #include "shtc1_linux.h"
+ #include "shtc1_internal.h"
+ 
+ /* messages per ioctl, every device takes one or two */
+ #define SHTC1_LINUX_BATCH_MSGS I2C_RDWR_IOCTL_MAX_MSGS
+ 
+ static inline struct shtc1_linux *shtc1_linux_from(struct shtc1_transport *transport)
+ {
+     return (struct shtc1_linux *)transport;
+ }
+ 
+ /* maps the errno of a failed transfer to the driver status codes */
+ static enum status_code shtc1_linux_status(int error)
+ {
+     switch (error) {
+     case ENXIO:
+     case EREMOTEIO:
+         return STATUS_ERR_BAD_ADDRESS;
+     case ETIMEDOUT:
+         return STATUS_ERR_TIMEOUT;
+     case EAGAIN:
+         return STATUS_ERR_PACKET_COLLISION;
+     default:
+         return STATUS_ERR_IO;
+     }
+ }
+ 
+ static enum status_code shtc1_linux_transfer(struct shtc1_linux *bus,
+         struct i2c_msg *msgs, uint32_t count)
+ {
+     struct i2c_rdwr_ioctl_data data = {
+             .msgs = msgs,
+             .nmsgs = count,
+     };
+ 
+     if (ioctl(bus->fd, I2C_RDWR, &data) < 0)
+         return shtc1_linux_status(errno);
+     return STATUS_OK;
+ }
+ 
+ static inline void shtc1_linux_msg(struct i2c_msg *msg, const struct shtc1_xfer *xfer,
+         uint16_t flags)
+ {
+     msg->addr = xfer->address;
+     msg->flags = flags;
+     msg->len = xfer->length;
+     msg->buf = xfer->data;
+ }
+ 
+ /*
+  * Every ioctl ends with a stop condition, SHTC1_XFER_NO_STOP can not be
+  * honoured across calls. The sensor accepts the readout after a stop as well.
+  */
+ static enum status_code shtc1_linux_write(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct i2c_msg msg;
+ 
+     shtc1_linux_msg(&msg, xfer, 0);
+     return shtc1_linux_transfer(shtc1_linux_from(transport), &msg, 1);
+ }
+ 
+ static enum status_code shtc1_linux_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct i2c_msg msg;
+ 
+     shtc1_linux_msg(&msg, xfer, I2C_M_RD);
+     return shtc1_linux_transfer(shtc1_linux_from(transport), &msg, 1);
+ }
+ 
+ static enum status_code shtc1_linux_write_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *write, const struct shtc1_xfer *read)
+ {
+     struct i2c_msg msgs[2];
+ 
+     shtc1_linux_msg(&msgs[0], write, 0);
+     shtc1_linux_msg(&msgs[1], read, I2C_M_RD);
+     return shtc1_linux_transfer(shtc1_linux_from(transport), msgs, 2);
+ }
+ 
+ static void shtc1_linux_delay_us(struct shtc1_transport *transport, uint32_t us)
+ {
+     struct timespec delay = {
+             .tv_sec = us / 1000000,
+             .tv_nsec = (long)(us % 1000000) * 1000,
+     };
+ 
+     (void)transport;
+     while (nanosleep(&delay, &delay) && errno == EINTR)
+         ;
+ }
+ 
+ static uint32_t shtc1_linux_timestamp_us(struct shtc1_transport *transport)
+ {
+     struct timespec now;
+ 
+     (void)transport;
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return (uint32_t)now.tv_sec * 1000000 + (uint32_t)(now.tv_nsec / 1000);
+ }
+ 
+ enum status_code shtc1_linux_init(struct shtc1_linux *bus, const char *path)
+ {
+     unsigned long funcs;
+ 
+     bus->fd = open(path, O_RDWR);
+     if (bus->fd < 0)
+         return STATUS_ERR_IO;
+     if (ioctl(bus->fd, I2C_FUNCS, &funcs) < 0 || !(funcs & I2C_FUNC_I2C)) {
+         close(bus->fd);
+         bus->fd = -1;
+         return STATUS_ERR_IO;
+     }
+ 
+     bus->protocol_mangling = (funcs & I2C_FUNC_PROTOCOL_MANGLING) != 0;
+     bus->transport.write = shtc1_linux_write;
+     bus->transport.read = shtc1_linux_read;
+     bus->transport.write_read = shtc1_linux_write_read;
+     bus->transport.delay_us = shtc1_linux_delay_us;
+     bus->transport.timestamp_us = shtc1_linux_timestamp_us;
+     /* the adapter driver recovers the bus on its own */
+     bus->transport.recover = NULL;
+     bus->transport.lock = NULL;
+     bus->transport.unlock = NULL;
+     bus->transport.write_async = NULL;
+     bus->transport.read_async = NULL;
+     return STATUS_OK;
+ }
+ 
+ void shtc1_linux_close(struct shtc1_linux *bus)
+ {
+     if (bus->fd >= 0)
+         close(bus->fd);
+     bus->fd = -1;
+ }
+ 
+ /*
+  * Appends the multiplexer selection, terminated by a stop so the channel
+  * becomes active, and the sensor access of a device.
+  */
+ static uint32_t shtc1_linux_add(struct shtc1_linux *bus, struct i2c_msg *msgs,
+         struct shtc1_dev *dev, uint16_t flags)
+ {
+     uint16_t stop = bus->protocol_mangling ? I2C_M_STOP : 0;
+     uint32_t count = 0;
+ 
+     if (dev->mux_address != SHTC1_NO_MUX) {
+         msgs[count].addr = dev->mux_address;
+         msgs[count].flags = stop;
+         msgs[count].len = sizeof(dev->mux_mask);
+         msgs[count].buf = &dev->mux_mask;
+         ++count;
+     }
+     shtc1_linux_msg(&msgs[count], &dev->xfer, flags | stop);
+     ++count;
+     return count;
+ }
+ 
+ /*
+  * Starts (readout false) or reads out all devices whose result status is
+  * STATUS_OK, as few ioctls as possible. A failing ioctl sets the status of all
+  * devices it carried.
+  */
+ static void shtc1_linux_batch(struct shtc1_linux *bus, struct shtc1_dev *devs,
+         struct shtc1_sched_result *results, uint8_t count, bool readout)
+ {
+     struct i2c_msg msgs[SHTC1_LINUX_BATCH_MSGS];
+     enum status_code ret;
+     uint32_t used = 0;
+     uint8_t first = 0;
+     uint8_t i, j;
+ 
+     for (i = 0; i <= count; ++i) {
+         /* flush when the next device may not fit or all are added */
+         if (used && (i == count || used + 2 > SHTC1_LINUX_BATCH_MSGS)) {
+             ret = shtc1_linux_transfer(bus, msgs, used);
+             for (j = first; ret && j < i; ++j) {
+                 if (results[j].status == STATUS_OK)
+                     results[j].status = ret;
+             }
+             used = 0;
+         }
+         if (!used)
+             first = i;
+         if (i == count)
+             break;
+         if (results[i].status != STATUS_OK)
+             continue;
+ 
+         devs[i].xfer.flags = 0;
+         if (readout) {
+             devs[i].xfer.length = SHTC1_FRAME_SIZE;
+             devs[i].xfer.data = devs[i].buffer;
+         } else {
+             devs[i].xfer.length = COMMAND_SIZE;
+             devs[i].xfer.data = (uint8_t *)CMD_MEASURE[shtc1_effective_mode(devs[i].mode)];
+             devs[i].last_start_us = shtc1_linux_timestamp_us(&bus->transport);
+         }
+         used += shtc1_linux_add(bus, &msgs[used], &devs[i], readout ? I2C_M_RD : 0);
+     }
+ }
+ 
+ enum status_code shtc1_linux_measure_batch(struct shtc1_linux *bus,
+         struct shtc1_dev *devs, struct shtc1_sched_result *results, uint8_t count,
+         enum shtc1_mode mode)
+ {
+     enum status_code ret = STATUS_OK;
+     struct shtc1_sched_result *result;
+     uint8_t i;
+ 
+     for (i = 0; i < count; ++i) {
+         if (devs[i].mux_address != SHTC1_NO_MUX && !bus->protocol_mangling)
+             return STATUS_ERR_UNSUPPORTED_DEV;
+     }
+     for (i = 0; i < count; ++i) {
+         devs[i].mode = mode;
+         results[i].status = STATUS_OK;
+     }
+ 
+     shtc1_linux_batch(bus, devs, results, count, false);
+     shtc1_linux_delay_us(&bus->transport, shtc1_get_max_duration_us(mode));
+     shtc1_linux_batch(bus, devs, results, count, true);
+ 
+     for (i = 0; i < count; ++i) {
+         result = &results[i];
+         if (result->status == STATUS_OK && !shtc1_check_frame(devs[i].buffer))
+             result->status = STATUS_ERR_BAD_DATA;
+         if (result->status == STATUS_OK)
+             shtc1_convert_frame(devs[i].buffer, &result->temp, &result->rh);
+         else if (ret == STATUS_OK)
+             ret = result->status;
+     }
+     return ret;
+ }
\ No newline at end of file
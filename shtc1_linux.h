@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 transport for Linux i2c-dev
+ *
+ * This module implements the driver transport on a /dev/i2c-N adapter through
+ * the I2C_RDWR ioctl. The command write and the readout of a clock stretching
+ * measurement or an ID read go out as one combined transfer, and
+ * shtc1_linux_measure_batch() starts and reads out a whole set of sensors
+ * with two ioctls. The SCL frequency and the adapter timeout are set by the
+ * kernel, the per transfer speed and timeout of the driver are ignored.
+ */
+
+ #ifndef SHTC1_LINUX_H_
+ #define SHTC1_LINUX_H_
+ 
+ #include "shtc1_transport.h"
+ #include "shtc1_sched.h"
+ 
+ struct shtc1_linux {
+     struct shtc1_transport transport;
+     int fd;
+     /** the adapter supports I2C_M_STOP inside a combined transfer */
+     bool protocol_mangling;
+ };
+ 
+ /**
+  * Opens an i2c-dev adapter and initializes the transport for it.
+  *
+  * @param bus   the transport to initialize
+  * @param path  the adapter device, e.g. "/dev/i2c-1"
+  * @return      STATUS_OK if the adapter was opened, STATUS_ERR_IO if it can
+  *              not be opened or does not support combined transfers
+  */
+ enum status_code shtc1_linux_init(struct shtc1_linux *bus, const char *path);
+ 
+ /**
+  * Closes the adapter of the transport.
+  *
+  * @param bus the initialized transport
+  */
+ void shtc1_linux_close(struct shtc1_linux *bus);
+ 
+ /**
+  * Measures a set of sensors on the adapter of the transport: the
+  * measurements are started with one ioctl, and after the conversion time all
+  * results are read back with a second one. Sensors behind a multiplexer need
+  * a stop condition between the channel selection and the access to the
+  * sensor, which requires an adapter with protocol mangling
+  * (I2C_FUNC_PROTOCOL_MANGLING). Up to 42 messages go into one ioctl, each
+  * sensor takes one, plus one for the multiplexer. Since a NACK aborts a
+  * whole combined transfer, all sensors of a failing ioctl get its status:
+  * a single absent or failing sensor marks every sensor batched with it as
+  * failed. Measure sensors that may be missing with the other functions of
+  * the driver instead.
+  *
+  * @param bus     the initialized transport
+  * @param devs    the device handles, all on this transport
+  * @param results receives one result per sensor
+  * @param count   the number of sensors
+  * @param mode    the measurement mode
+  * @return        STATUS_OK if all sensors were measured successfully, else an
+  *                error code, STATUS_ERR_UNSUPPORTED_DEV for multiplexed
+  *                sensors on an adapter without protocol mangling
+  */
+ enum status_code shtc1_linux_measure_batch(struct shtc1_linux *bus,
+         struct shtc1_dev *devs, struct shtc1_sched_result *results, uint8_t count,
+         enum shtc1_mode mode);
+ 
+ #endif /* SHTC1_LINUX_H_ */
\ No newline at end of file
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 flash page logger implementation
+ *
+ * This module collects sample records in flash pages, see shtc1_log.h.
+ */
+
+ #include <string.h>
+ #include "shtc1_log.h"
+ 
+ #define LOG_MAGIC 0xc1
+ 
+ /* largest sample: flags, codec sample, delta_ms */
+ #define LOG_MAX_SAMPLE_SIZE (1 + SHTC1_CODEC_MAX_SIZE + SHTC1_VARINT_MAX_SIZE)
+ 
+ static uint8_t shtc1_log_encode(struct shtc1_encoder *encoder, uint8_t *buffer,
+         const struct shtc1_record *record)
+ {
+     uint8_t size = 0;
+ 
+     buffer[size++] = record->flags;
+     size += shtc1_encode(encoder, record->raw_t, record->raw_rh, &buffer[size]);
+     size += shtc1_varint_put(&buffer[size], record->delta_ms);
+     return size;
+ }
+ 
+ static uint8_t shtc1_log_header_crc(const uint8_t *page)
+ {
+     return shtc1_crc8(page, SHTC1_LOG_HEADER_SIZE - 1);
+ }
+ 
+ static bool shtc1_log_page_valid(const uint8_t *page)
+ {
+     return page[0] == LOG_MAGIC && page[SHTC1_LOG_HEADER_SIZE - 1] == shtc1_log_header_crc(page);
+ }
+ 
+ static inline uint32_t shtc1_log_page_sequence(const uint8_t *page)
+ {
+     return ((uint32_t)page[1] << 24) | ((uint32_t)page[2] << 16) |
+             ((uint32_t)page[3] << 8) | page[4];
+ }
+ 
+ static void shtc1_log_reset_page(struct shtc1_log *log)
+ {
+     memset(log->page, 0xff, sizeof(log->page));
+     log->used = SHTC1_LOG_HEADER_SIZE;
+     log->count = 0;
+     /* every page starts with a keyframe so it decodes on its own */
+     shtc1_encoder_init(&log->encoder, 0);
+ }
+ 
+ enum status_code shtc1_log_init(struct shtc1_log *log, struct shtc1_log_flash *flash)
+ {
+     enum status_code ret;
+     uint32_t newest = 0;
+     uint32_t sequence;
+     bool found = false;
+     uint32_t page;
+ 
+     log->flash = flash;
+     log->next_page = 0;
+     log->sequence = 0;
+ 
+     for (page = 0; page < flash->page_count; ++page) {
+         ret = flash->read_page(flash, page, log->page);
+         if (ret)
+             return ret;
+         if (!shtc1_log_page_valid(log->page))
+             continue;
+         sequence = shtc1_log_page_sequence(log->page);
+         /* sequence numbers wrap, compare by difference */
+         if (!found || (int32_t)(sequence - newest) > 0) {
+             newest = sequence;
+             log->next_page = page + 1 < flash->page_count ? page + 1 : 0;
+             log->sequence = sequence + 1;
+             found = true;
+         }
+     }
+ 
+     shtc1_log_reset_page(log);
+     return STATUS_OK;
+ }
+ 
+ enum status_code shtc1_log_flush(struct shtc1_log *log)
+ {
+     struct shtc1_log_flash *flash = log->flash;
+     enum status_code ret;
+ 
+     if (!log->count)
+         return STATUS_OK;
+ 
+     log->page[0] = LOG_MAGIC;
+     log->page[1] = log->sequence >> 24;
+     log->page[2] = (log->sequence >> 16) & 0xff;
+     log->page[3] = (log->sequence >> 8) & 0xff;
+     log->page[4] = log->sequence & 0xff;
+     log->page[5] = log->count >> 8;
+     log->page[6] = log->count & 0xff;
+     log->page[7] = shtc1_log_header_crc(log->page);
+ 
+     ret = flash->write_page(flash, log->next_page, log->page);
+     if (ret)
+         return ret;
+ 
+     log->next_page = log->next_page + 1 < flash->page_count ? log->next_page + 1 : 0;
+     ++log->sequence;
+     shtc1_log_reset_page(log);
+     return STATUS_OK;
+ }
+ 
+ enum status_code shtc1_log_append(struct shtc1_log *log, const struct shtc1_record *record)
+ {
+     struct shtc1_encoder encoder = log->encoder;
+     uint8_t sample[LOG_MAX_SAMPLE_SIZE];
+     enum status_code ret;
+     uint8_t size;
+ 
+     size = shtc1_log_encode(&encoder, sample, record);
+     if (log->used + size > SHTC1_LOG_PAGE_SIZE) {
+         ret = shtc1_log_flush(log);
+         if (ret)
+             return ret;
+         encoder = log->encoder;
+         size = shtc1_log_encode(&encoder, sample, record);
+     }
+ 
+     memcpy(&log->page[log->used], sample, size);
+     log->used += size;
+     ++log->count;
+     log->encoder = encoder;
+     return STATUS_OK;
+ }
+ 
+ void shtc1_log_reader_init(struct shtc1_log_reader *reader, const struct shtc1_log *log)
+ {
+     reader->log = log;
+     /* the page written next is the oldest one once the area has wrapped */
+     reader->pages_left = log->flash->page_count;
+     reader->next_page = log->next_page;
+     reader->offset = 0;
+     reader->remaining = 0;
+ }
+ 
+ /* loads the next page with samples, STATUS_ERR_NOT_FOUND at the end of the log */
+ static enum status_code shtc1_log_next_page(struct shtc1_log_reader *reader)
+ {
+     struct shtc1_log_flash *flash = reader->log->flash;
+     enum status_code ret;
+ 
+     while (reader->pages_left) {
+         --reader->pages_left;
+         ret = flash->read_page(flash, reader->next_page, reader->page);
+         reader->next_page = reader->next_page + 1 < flash->page_count ?
+                 reader->next_page + 1 : 0;
+         if (ret)
+             return ret;
+         if (!shtc1_log_page_valid(reader->page))
+             continue;
+ 
+         reader->remaining = (uint16_t)((reader->page[5] << 8) | reader->page[6]);
+         reader->offset = SHTC1_LOG_HEADER_SIZE;
+         shtc1_decoder_init(&reader->decoder);
+         if (reader->remaining)
+             return STATUS_OK;
+     }
+     return STATUS_ERR_NOT_FOUND;
+ }
+ 
+ enum status_code shtc1_log_read(struct shtc1_log_reader *reader, struct shtc1_record *record)
+ {
+     const uint8_t *data;
+     uint16_t available;
+     enum status_code ret;
+     uint32_t delta_ms;
+     uint8_t length;
+     uint8_t size;
+ 
+     if (!reader->remaining) {
+         ret = shtc1_log_next_page(reader);
+         if (ret)
+             return ret;
+     }
+ 
+     data = &reader->page[reader->offset];
+     available = SHTC1_LOG_PAGE_SIZE - reader->offset;
+     size = 1;
+     length = available > size ? shtc1_decode(&reader->decoder, &data[size],
+             available - size, &record->raw_t, &record->raw_rh) : 0;
+     if (length) {
+         size += length;
+         length = shtc1_varint_get(&data[size], available - size, &delta_ms);
+     }
+     if (!length) {
+         /* skip the rest of a corrupted page */
+         reader->remaining = 0;
+         return STATUS_ERR_BAD_FORMAT;
+     }
+ 
+     record->flags = data[0];
+     record->delta_ms = (uint16_t)delta_ms;
+     reader->offset += size + length;
+     --reader->remaining;
+     return STATUS_OK;
+ }
\ No newline at end of file
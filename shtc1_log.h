@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 flash page logger
+ *
+ * This module collects sample records in a RAM page and writes it to flash
+ * only when it is full, so every flash write is a whole page. The raw signals
+ * are compressed with the codec of shtc1_codec.h, starting every page with a
+ * keyframe so pages decode on their own. A slowly changing sample then takes
+ * 4 to 6 bytes instead of a 7 byte packed record. Pages are written
+ * round-robin across the whole log area to spread the wear, each carries a
+ * sequence number so the log is read back oldest first after a restart.
+ *
+ * Page layout: magic, sequence number (4 bytes, big endian), sample count
+ * (2 bytes, big endian), CRC-8 of the preceding header bytes, samples.
+ * Sample layout: SHTC1_RECORD_* flags, codec sample, varint delta_ms.
+ */
+
+ #ifndef SHTC1_LOG_H_
+ #define SHTC1_LOG_H_
+ 
+ #include "shtc1_record.h"
+ #include "shtc1_codec.h"
+ 
+ /* size of a flash page in bytes */
+ #ifndef SHTC1_LOG_PAGE_SIZE
+ #define SHTC1_LOG_PAGE_SIZE 256
+ #endif
+ 
+ #define SHTC1_LOG_HEADER_SIZE 8
+ 
+ /**
+  * Flash area of a log. A platform implementation embeds it as its first
+  * member and fills in the operations.
+  */
+ struct shtc1_log_flash {
+     /**
+      * Erases and programs a whole page.
+      * @return STATUS_OK if the page was written, else an error code.
+      */
+     enum status_code (*write_page)(struct shtc1_log_flash *flash, uint32_t page,
+             const uint8_t *data);
+     /**
+      * Reads a whole page.
+      * @return STATUS_OK if the page was read, else an error code.
+      */
+     enum status_code (*read_page)(struct shtc1_log_flash *flash, uint32_t page,
+             uint8_t *data);
+     /** number of pages of the log area */
+     uint32_t page_count;
+ };
+ 
+ struct shtc1_log {
+     struct shtc1_log_flash *flash;
+     /** page being filled */
+     uint8_t page[SHTC1_LOG_PAGE_SIZE];
+     uint16_t used;
+     uint16_t count;
+     /** the page written next and its sequence number */
+     uint32_t next_page;
+     uint32_t sequence;
+     struct shtc1_encoder encoder;
+ };
+ 
+ struct shtc1_log_reader {
+     const struct shtc1_log *log;
+     uint8_t page[SHTC1_LOG_PAGE_SIZE];
+     /** pages not yet visited and the page read next */
+     uint32_t pages_left;
+     uint32_t next_page;
+     /** position and samples left in the current page */
+     uint16_t offset;
+     uint16_t remaining;
+     struct shtc1_decoder decoder;
+ };
+ 
+ /**
+  * Initializes a log on a flash area and continues after the newest page
+  * found in it. Reads every page once.
+  *
+  * @param log   the log to initialize
+  * @param flash the flash area
+  * @return      STATUS_OK if the flash area was scanned, else an error code.
+  */
+ enum status_code shtc1_log_init(struct shtc1_log *log, struct shtc1_log_flash *flash);
+ 
+ /**
+  * Adds a sample to the log, writing the page to flash if it is full.
+  *
+  * @param log    the initialized log
+  * @param record the sample
+  * @return       STATUS_OK if the sample was added, else the error code of
+  *               the page write. On failure the sample is not added and the
+  *               full page is kept, so appending the sample again retries the
+  *               write.
+  */
+ enum status_code shtc1_log_append(struct shtc1_log *log, const struct shtc1_record *record);
+ 
+ /**
+  * Writes the page being filled to flash, e.g. before power down. The next
+  * sample starts a new page.
+  *
+  * @param log the initialized log
+  * @return    STATUS_OK if the page was written or empty, else an error code.
+  */
+ enum status_code shtc1_log_flush(struct shtc1_log *log);
+ 
+ /**
+  * Starts reading back the pages of a log in the order they were written.
+  * Samples not yet written to flash are not included.
+  *
+  * @param reader the reader to initialize
+  * @param log    the initialized log
+  */
+ void shtc1_log_reader_init(struct shtc1_log_reader *reader, const struct shtc1_log *log);
+ 
+ /**
+  * Reads the next sample of a log.
+  *
+  * @param reader the reader
+  * @param record receives the sample
+  * @return       STATUS_OK if a sample was read, STATUS_ERR_NOT_FOUND at the
+  *               end of the log, else an error code.
+  */
+ enum status_code shtc1_log_read(struct shtc1_log_reader *reader, struct shtc1_record *record);
+ 
+ #endif /* SHTC1_LOG_H_ */
\ No newline at end of file
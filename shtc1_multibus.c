@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 multi-bus acquisition implementation
+ *
+ * This module measures the sensors of several I2C masters concurrently, see
+ * shtc1_multibus.h. The completion interrupts of different buses may preempt
+ * each other, so the count of active buses is updated with interrupts
+ * masked. The Cortex-M0+ has no exclusive accesses for an atomic decrement.
+ */
+
+ #include "shtc1_multibus.h"
+ #include "shtc1_internal.h"
+ 
+ static void shtc1_multibus_measured(struct shtc1_async *async, enum status_code status,
+         int temp, int rh);
+ 
+ /* starts the next sensor of a bus that can be started, or finishes the bus */
+ static void shtc1_multibus_next(struct shtc1_multibus_bus *bus)
+ {
+     struct shtc1_multibus *engine = bus->engine;
+     enum status_code ret;
+     uint32_t flags;
+     bool finished;
+ 
+     while (bus->next < bus->count) {
+         ret = shtc1_async_init(&bus->async, &bus->devs[bus->next], engine->start_timer,
+                 shtc1_multibus_measured);
+         if (ret == STATUS_OK)
+             ret = shtc1_async_start(&bus->async, engine->mode);
+         if (ret == STATUS_OK)
+             return;
+         bus->results[bus->next].status = ret;
+         ++bus->next;
+     }
+ 
+     SHTC1_ENTER_CRITICAL(flags);
+     finished = --engine->active == 0;
+     SHTC1_EXIT_CRITICAL(flags);
+     if (finished)
+         engine->done(engine);
+ }
+ 
+ static void shtc1_multibus_measured(struct shtc1_async *async, enum status_code status,
+         int temp, int rh)
+ {
+     struct shtc1_multibus_bus *bus = shtc1_multibus_bus_of(async);
+     struct shtc1_sched_result *result = &bus->results[bus->next];
+ 
+     result->status = status;
+     result->temp = temp;
+     result->rh = rh;
+     ++bus->next;
+     shtc1_multibus_next(bus);
+ }
+ 
+ void shtc1_multibus_init_bus(struct shtc1_multibus_bus *bus, struct shtc1_dev *devs,
+         struct shtc1_sched_result *results, uint8_t count)
+ {
+     bus->engine = NULL;
+     bus->devs = devs;
+     bus->results = results;
+     bus->count = count;
+     bus->next = 0;
+     bus->async.state = SHTC1_ASYNC_IDLE;
+ }
+ 
+ void shtc1_multibus_init(struct shtc1_multibus *engine, struct shtc1_multibus_bus *buses,
+         uint8_t bus_count, shtc1_async_timer_t start_timer, shtc1_multibus_done_t done)
+ {
+     uint8_t i;
+ 
+     engine->buses = buses;
+     engine->bus_count = bus_count;
+     engine->start_timer = start_timer;
+     engine->done = done;
+     engine->user_data = NULL;
+     engine->mode = SHTC1_MODE_HPM;
+     engine->active = 0;
+     for (i = 0; i < bus_count; ++i)
+         buses[i].engine = engine;
+ }
+ 
+ enum status_code shtc1_multibus_start(struct shtc1_multibus *engine, enum shtc1_mode mode)
+ {
+     uint8_t i;
+ 
+     if (engine->active)
+         return STATUS_BUSY;
+     if (!engine->bus_count) {
+         engine->done(engine);
+         return STATUS_OK;
+     }
+ 
+     engine->mode = mode;
+     for (i = 0; i < engine->bus_count; ++i)
+         engine->buses[i].next = 0;
+     /* counted up front, a bus may finish before the others are started */
+     engine->active = engine->bus_count;
+     SHTC1_MEMORY_BARRIER();
+ 
+     for (i = 0; i < engine->bus_count; ++i)
+         shtc1_multibus_next(&engine->buses[i]);
+     return STATUS_OK;
+ }
\ No newline at end of file
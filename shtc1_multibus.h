@@ -0,0 +1,130 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 multi-bus acquisition interface
+ *
+ * This module measures the sensors of several I2C masters concurrently with
+ * the non-blocking state machine of shtc1_async.h. Every bus works through its
+ * own list of sensors one measurement at a time, driven by the completion
+ * interrupts of its transport, so all buses are busy at once and the
+ * throughput grows with the number of buses while the CPU stays free.
+ */
+
+ #ifndef SHTC1_MULTIBUS_H_
+ #define SHTC1_MULTIBUS_H_
+ 
+ #include "shtc1_async.h"
+ #include "shtc1_sched.h"
+ 
+ struct shtc1_multibus;
+ 
+ /**
+  * Called from interrupt context when all sensors of a cycle have been
+  * measured.
+  *
+  * @param engine the engine that completed the cycle
+  */
+ typedef void (*shtc1_multibus_done_t)(struct shtc1_multibus *engine);
+ 
+ /**
+  * The sensors of one I2C master.
+  */
+ struct shtc1_multibus_bus {
+     /** measurement context of the bus, first so callbacks find the bus */
+     struct shtc1_async async;
+     struct shtc1_multibus *engine;
+     /** device handles, all on the same transport */
+     struct shtc1_dev *devs;
+     struct shtc1_sched_result *results;
+     uint8_t count;
+     /** the sensor being measured */
+     volatile uint8_t next;
+ };
+ 
+ struct shtc1_multibus {
+     struct shtc1_multibus_bus *buses;
+     uint8_t bus_count;
+     shtc1_async_timer_t start_timer;
+     shtc1_multibus_done_t done;
+     /** free for use by the application */
+     void *user_data;
+ 
+     enum shtc1_mode mode;
+     /** buses that have not finished the current cycle */
+     volatile uint8_t active;
+ };
+ 
+ /**
+  * Initializes the sensor list of a bus.
+  *
+  * @param bus     the bus to initialize
+  * @param devs    the initialized device handles, their transport must provide
+  *                the non-blocking operations
+  * @param results storage for one result per sensor
+  * @param count   the number of sensors
+  */
+ void shtc1_multibus_init_bus(struct shtc1_multibus_bus *bus, struct shtc1_dev *devs,
+         struct shtc1_sched_result *results, uint8_t count);
+ 
+ /**
+  * Initializes an engine for a set of buses, each with its own transport.
+  *
+  * @param engine      the engine to initialize
+  * @param buses       the initialized buses
+  * @param bus_count   the number of buses
+  * @param start_timer arms a conversion timer of the application, see
+  *                    shtc1_async_timer_t. Buses run concurrently, so one timer
+  *                    per bus is needed; the bus is the container of the
+  *                    context passed.
+  * @param done        called when a cycle has completed
+  */
+ void shtc1_multibus_init(struct shtc1_multibus *engine, struct shtc1_multibus_bus *buses,
+         uint8_t bus_count, shtc1_async_timer_t start_timer, shtc1_multibus_done_t done);
+ 
+ /**
+  * Starts measuring all sensors of all buses once and returns immediately.
+  * The per sensor status is stored in the results of the buses, done is
+  * called once the last bus has finished.
+  *
+  * @param engine the engine
+  * @param mode   the measurement mode
+  * @return       STATUS_OK if the cycle was started, STATUS_BUSY if a cycle is
+  *               in flight
+  */
+ enum status_code shtc1_multibus_start(struct shtc1_multibus *engine, enum shtc1_mode mode);
+ 
+ /**
+  * @param engine the engine to check
+  * @return true if a cycle is in flight
+  */
+ static inline bool shtc1_multibus_busy(const struct shtc1_multibus *engine)
+ {
+     return engine->active != 0;
+ }
+ 
+ /**
+  * @param async a context passed to the start_timer of an engine
+  * @return the bus the context belongs to
+  */
+ static inline struct shtc1_multibus_bus *shtc1_multibus_bus_of(struct shtc1_async *async)
+ {
+     return (struct shtc1_multibus_bus *)async;
+ }
+ 
+ #endif /* SHTC1_MULTIBUS_H_ */
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 packed sample records implementation
+ *
+ * This module stores results as packed records, see shtc1_record.h.
+ */
+
+ #include "shtc1_record.h"
+ #include "shtc1_internal.h"
+ 
+ void shtc1_record_pack(uint8_t *buffer, const struct shtc1_record *record)
+ {
+     buffer[0] = record->raw_t >> 8;
+     buffer[1] = record->raw_t & 0xff;
+     buffer[2] = record->raw_rh >> 8;
+     buffer[3] = record->raw_rh & 0xff;
+     buffer[4] = record->delta_ms >> 8;
+     buffer[5] = record->delta_ms & 0xff;
+     buffer[6] = record->flags;
+ }
+ 
+ void shtc1_record_unpack(struct shtc1_record *record, const uint8_t *buffer)
+ {
+     record->raw_t = (uint16_t)((buffer[0] << 8) | buffer[1]);
+     record->raw_rh = (uint16_t)((buffer[2] << 8) | buffer[3]);
+     record->delta_ms = (uint16_t)((buffer[4] << 8) | buffer[5]);
+     record->flags = buffer[6];
+ }
+ 
+ #if SHTC1_CONFIG_ASYNC
+ enum status_code shtc1_read_async_result_record(struct shtc1_dev *dev,
+         uint32_t *reference_us, uint8_t *buffer)
+ {
+     struct shtc1_record record = { 0 };
+     uint32_t delta_ms = (dev->last_start_us - *reference_us) / 1000;
+     enum status_code ret;
+ 
+     ret = shtc1_read_async_result_raw(dev, &record.raw_t, &record.raw_rh);
+     if (ret == STATUS_ERR_BAD_DATA)
+         record.flags |= SHTC1_RECORD_BAD_DATA;
+     else if (ret)
+         record.flags |= SHTC1_RECORD_BUS_ERROR;
+     if (shtc1_effective_mode(dev->mode) == SHTC1_MODE_HPM)
+         record.flags |= SHTC1_RECORD_HPM;
+     if (delta_ms > UINT16_MAX) {
+         delta_ms = UINT16_MAX;
+         record.flags |= SHTC1_RECORD_TIME_GAP;
+     }
+     record.delta_ms = (uint16_t)delta_ms;
+ 
+     shtc1_record_pack(buffer, &record);
+     /* keep the sub-millisecond remainder, the sum of the deltas must not drift */
+     *reference_us += delta_ms * 1000;
+     return ret;
+ }
+ #endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 packed sample records
+ *
+ * This module stores results as packed 7 byte records that can be sent over
+ * the air or written to flash as they are:
+ *
+ *   byte 0-1 temperature signal, big endian as sent by the sensor
+ *   byte 2-3 humidity signal, big endian
+ *   byte 4-5 start of the measurement relative to the previous record in
+ *            ms, big endian, saturated at 0xffff
+ *   byte 6   SHTC1_RECORD_* flags
+ *
+ * The signals are converted with shtc1_raw_to_*() on the receiving side.
+ */
+
+ #ifndef SHTC1_RECORD_H_
+ #define SHTC1_RECORD_H_
+ 
+ #include "shtc1.h"
+ 
+ #define SHTC1_RECORD_SIZE 7
+ 
+ /* record flags */
+ /** measured in high precision mode */
+ #define SHTC1_RECORD_HPM       0x01
+ /** the checksum of the result did not match, the signals are not valid */
+ #define SHTC1_RECORD_BAD_DATA  0x02
+ /** the sensor did not respond or the bus failed, the signals are not valid */
+ #define SHTC1_RECORD_BUS_ERROR 0x04
+ /** the delta timestamp is saturated */
+ #define SHTC1_RECORD_TIME_GAP  0x08
+ 
+ /**
+  * Unpacked form of a record.
+  */
+ struct shtc1_record {
+     uint16_t raw_t;
+     uint16_t raw_rh;
+     uint16_t delta_ms;
+     uint8_t flags;
+ };
+ 
+ /**
+  * Packs a record.
+  *
+  * @param buffer the destination, SHTC1_RECORD_SIZE bytes
+  * @param record the record to pack
+  */
+ void shtc1_record_pack(uint8_t *buffer, const struct shtc1_record *record);
+ 
+ /**
+  * Unpacks a record.
+  *
+  * @param record receives the record
+  * @param buffer the packed record, SHTC1_RECORD_SIZE bytes
+  */
+ void shtc1_record_unpack(struct shtc1_record *record, const uint8_t *buffer);
+ 
+ #if SHTC1_CONFIG_ASYNC
+ /**
+  * Reads out the results of a measurement previously started with
+  * shtc1_read_async() and packs them into a record. A record is written on
+  * failures as well, flagged accordingly, so gaps in the series stay visible.
+  *
+  * @param dev          the device handle
+  * @param reference_us the time base of the deltas, advanced by the delta of
+  *                     this record in whole ms so that the sum of the deltas
+  *                     follows the start times without drift
+  * @param buffer       the destination, SHTC1_RECORD_SIZE bytes
+  * @return             STATUS_OK if the readout was successful, else an error code.
+  */
+ enum status_code shtc1_read_async_result_record(struct shtc1_dev *dev,
+         uint32_t *reference_us, uint8_t *buffer);
+ #endif
+ 
+ #endif /* SHTC1_RECORD_H_ */
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 multi-sensor scheduler implementation
+ *
+ * This module measures a set of sensors, each reachable through its own I2C
+ * master instance and optional I2C multiplexer channel as configured in its
+ * device handle, in a pipelined way:
+ * the measurements of all sensors are started back to back and read out
+ * after a single conversion time, instead of paying the conversion time once
+ * per sensor.
+ */
+
+ #include "shtc1_sched.h"
+ 
+ #if !SHTC1_CONFIG_ASYNC
+ #error The scheduler requires SHTC1_CONFIG_ASYNC
+ #endif
+ 
+ void shtc1_sched_init(struct shtc1_sched *sched, struct shtc1_dev *devs,
+         struct shtc1_sched_result *results, uint8_t count)
+ {
+     sched->devs = devs;
+     sched->results = results;
+     sched->count = count;
+ }
+ 
+ enum status_code shtc1_sched_run(struct shtc1_sched *sched, enum shtc1_mode mode)
+ {
+     enum status_code ret = STATUS_OK;
+     struct shtc1_sched_result *result;
+     struct shtc1_dev *dev;
+     uint8_t i;
+ 
+     /* start all measurements back to back */
+     for (i = 0; i < sched->count; ++i) {
+         dev = &sched->devs[i];
+         dev->mode = mode;
+         sched->results[i].status = shtc1_read_async(dev);
+     }
+ 
+     if (sched->count)
+         sched->devs[0].transport->delay_us(sched->devs[0].transport,
+                 shtc1_get_max_duration_us(mode));
+ 
+     /* collect the results in start order */
+     for (i = 0; i < sched->count; ++i) {
+         dev = &sched->devs[i];
+         result = &sched->results[i];
+         if (result->status == STATUS_OK)
+             result->status = shtc1_read_async_result(dev, &result->temp, &result->rh);
+         if (result->status != STATUS_OK && ret == STATUS_OK)
+             ret = result->status;
+     }
+ 
+     return ret;
+ }
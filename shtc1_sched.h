@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 multi-sensor scheduler interface
+ *
+ * This module measures a set of sensors, each reachable through its own I2C
+ * master instance and optional I2C multiplexer channel as configured in its
+ * device handle, in a pipelined way:
+ * the measurements of all sensors are started back to back and read out
+ * after a single conversion time, instead of paying the conversion time once
+ * per sensor.
+ */
+
+ #ifndef SHTC1_SCHED_H_
+ #define SHTC1_SCHED_H_
+ 
+ #include "shtc1.h"
+ 
+ struct shtc1_sched_result {
+     /** STATUS_OK if temp and rh are valid, else an error code */
+     enum status_code status;
+     /** temperature in 1/1000 C, 1/100 C with SHTC1_OUTPUT_CENTI */
+     int temp;
+     /** relative humidity in 1/1000 percent, 1/100 percent with SHTC1_OUTPUT_CENTI */
+     int rh;
+ };
+ 
+ struct shtc1_sched {
+     struct shtc1_dev *devs;
+     struct shtc1_sched_result *results;
+     uint8_t count;
+ };
+ 
+ /**
+  * Initializes a scheduler for the given sensors.
+  *
+  * @param sched   the scheduler to initialize
+  * @param devs    the initialized device handles of the sensors
+  * @param results storage for one result per sensor
+  * @param count   the number of sensors
+  */
+ void shtc1_sched_init(struct shtc1_sched *sched, struct shtc1_dev *devs,
+         struct shtc1_sched_result *results, uint8_t count);
+ 
+ /**
+  * Measures all sensors of the scheduler once. The measurements are started
+  * one after the other without clock stretching, and read out in the same
+  * order once the conversion time of the first sensor has expired. Since a
+  * readout takes longer than a start, every sensor has finished converting
+  * when its turn comes.
+  * One cycle takes one conversion time plus the bus time of all sensors.
+  *
+  * @param sched the scheduler
+  * @param mode  the measurement mode
+  * @return      STATUS_OK if all sensors were measured successfully, else the
+  *              error code of the first failing sensor. The per sensor status
+  *              is stored in the results.
+  */
+ enum status_code shtc1_sched_run(struct shtc1_sched *sched, enum shtc1_mode mode);
+ 
+ #endif /* SHTC1_SCHED_H_ */
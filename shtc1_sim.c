@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2014, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 simulated transport implementation
+ *
+ * This module implements the driver transport on a simulated bus, see
+ * shtc1_sim.h.
+ */
+
+ #include <string.h>
+ #include "shtc1_sim.h"
+ #include "shtc1.h"
+ #include "shtc1_internal.h"
+ 
+ /* typical wakeup time according to the SHTC3 datasheet in microseconds */
+ static const uint16_t SIM_WAKEUP_US = 180;
+ 
+ /* typical conversion times according to the SHTC1 datasheet in microseconds */
+ static const uint16_t SIM_CONVERSION_US[] = {
+     [SHTC1_MODE_LPM] = 700,
+     [SHTC1_MODE_HPM] = 10800,
+ };
+ 
+ static inline struct shtc1_sim *shtc1_sim_from(struct shtc1_transport *transport)
+ {
+     return (struct shtc1_sim *)transport;
+ }
+ 
+ /* advances the virtual clock by the time of a transfer of length bytes */
+ static void shtc1_sim_clock_bytes(struct shtc1_sim *sim, const struct shtc1_xfer *xfer,
+         bool stop)
+ {
+     /* start, 9 clocks per byte including the acknowledge, optional stop */
+     uint32_t bits = 1 + 9 * (1 + (uint32_t)xfer->length) + (stop ? 1 : 0);
+     uint32_t speed_khz = xfer->speed_khz ? xfer->speed_khz : sim->speed_khz;
+     uint32_t time_us = (bits * 1000 + speed_khz - 1) / speed_khz;
+ 
+     ++sim->transfers;
+     sim->now_us += time_us;
+     sim->bus_busy_us += time_us;
+ }
+ 
+ /* returns the selected sensor, NULL if none acknowledges the address */
+ static struct shtc1_sim_sensor *shtc1_sim_sensor(struct shtc1_sim *sim)
+ {
+     uint8_t channel;
+ 
+     if (sim->mux_address == SHTC1_NO_MUX)
+         return sim->sensors[0].present ? &sim->sensors[0] : NULL;
+     /* the sensors share the address, only a single channel is supported */
+     for (channel = 0; channel < SHTC1_SIM_SENSORS; ++channel) {
+         if (sim->mux_mask == 1 << channel)
+             return sim->sensors[channel].present ? &sim->sensors[channel] : NULL;
+     }
+     return NULL;
+ }
+ 
+ static void shtc1_sim_set_result(struct shtc1_sim_sensor *sensor)
+ {
+     sensor->response[0] = sensor->raw_t >> 8;
+     sensor->response[1] = sensor->raw_t & 0xff;
+     sensor->response[2] = shtc1_crc8(&sensor->response[0], 2);
+     sensor->response[3] = sensor->raw_rh >> 8;
+     sensor->response[4] = sensor->raw_rh & 0xff;
+     sensor->response[5] = shtc1_crc8(&sensor->response[3], 2);
+     if (sensor->corrupt) {
+         --sensor->corrupt;
+         sensor->response[5] ^= 0x01;
+     }
+     sensor->response_length = SHTC1_FRAME_SIZE;
+ }
+ 
+ static void shtc1_sim_start(struct shtc1_sim *sim, struct shtc1_sim_sensor *sensor,
+         enum shtc1_mode mode, bool stretch)
+ {
+     sensor->busy = true;
+     sensor->stretch = stretch;
+     sensor->ready_us = sim->now_us + sim->conversion_us[mode];
+     sensor->response_length = 0;
+ }
+ 
+ static enum status_code shtc1_sim_command(struct shtc1_sim *sim,
+         struct shtc1_sim_sensor *sensor, const uint8_t *command)
+ {
+     if (!memcmp(command, CMD_WAKEUP, COMMAND_SIZE)) {
+         if (sensor->asleep)
+             sensor->awake_us = sim->now_us + SIM_WAKEUP_US;
+         sensor->asleep = false;
+     } else if (sensor->asleep || sim->now_us < sensor->awake_us) {
+         /* only the wakeup command is accepted while sleeping or waking up */
+         return STATUS_ERR_OVERFLOW;
+     } else if (!memcmp(command, CMD_SOFT_RESET, COMMAND_SIZE)) {
+         sensor->busy = false;
+         sensor->response_length = 0;
+     } else if (sensor->busy) {
+         /* commands are only accepted after the result has been read */
+         return STATUS_ERR_OVERFLOW;
+     } else if (!memcmp(command, CMD_MEASURE_LPM, COMMAND_SIZE)) {
+         shtc1_sim_start(sim, sensor, SHTC1_MODE_LPM, false);
+     } else if (!memcmp(command, CMD_MEASURE_HPM, COMMAND_SIZE)) {
+         shtc1_sim_start(sim, sensor, SHTC1_MODE_HPM, false);
+     } else if (!memcmp(command, CMD_MEASURE_LPM_CS, COMMAND_SIZE)) {
+         shtc1_sim_start(sim, sensor, SHTC1_MODE_LPM, true);
+     } else if (!memcmp(command, CMD_MEASURE_HPM_CS, COMMAND_SIZE)) {
+         shtc1_sim_start(sim, sensor, SHTC1_MODE_HPM, true);
+     } else if (!memcmp(command, CMD_SLEEP, COMMAND_SIZE)) {
+         sensor->asleep = true;
+     } else if (!memcmp(command, CMD_READ_ID_REG, COMMAND_SIZE)) {
+         /* ID register content of an SHTC1 */
+         sensor->response[0] = 0x00;
+         sensor->response[1] = 0x07;
+         sensor->response[2] = shtc1_crc8(sensor->response, 2);
+         sensor->response_length = 3;
+     } else {
+         return STATUS_ERR_OVERFLOW;
+     }
+     return STATUS_OK;
+ }
+ 
+ static enum status_code shtc1_sim_write(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct shtc1_sim *sim = shtc1_sim_from(transport);
+     struct shtc1_sim_sensor *sensor;
+ 
+     shtc1_sim_clock_bytes(sim, xfer, !(xfer->flags & SHTC1_XFER_NO_STOP));
+ 
+     if (sim->mux_address != SHTC1_NO_MUX && xfer->address == sim->mux_address) {
+         if (xfer->length)
+             sim->mux_mask = xfer->data[xfer->length - 1];
+         return STATUS_OK;
+     }
+ 
+     sensor = shtc1_sim_sensor(sim);
+     if (xfer->address != SHTC1_ADDRESS || !sensor ||
+             (sensor->busy && !sensor->stretch && sim->now_us < sensor->ready_us)) {
+         ++sim->nacks;
+         return STATUS_ERR_BAD_ADDRESS;
+     }
+     if (xfer->length != COMMAND_SIZE)
+         return STATUS_ERR_OVERFLOW;
+     return shtc1_sim_command(sim, sensor, xfer->data);
+ }
+ 
+ static enum status_code shtc1_sim_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer)
+ {
+     struct shtc1_sim *sim = shtc1_sim_from(transport);
+     struct shtc1_sim_sensor *sensor = shtc1_sim_sensor(sim);
+     uint32_t stretch_us;
+ 
+     shtc1_sim_clock_bytes(sim, xfer, !(xfer->flags & SHTC1_XFER_NO_STOP));
+ 
+     if (xfer->address != SHTC1_ADDRESS || !sensor) {
+         ++sim->nacks;
+         return STATUS_ERR_BAD_ADDRESS;
+     }
+ 
+     if (sensor->busy) {
+         if (sim->now_us < sensor->ready_us) {
+             if (!sensor->stretch) {
+                 ++sim->nacks;
+                 return STATUS_ERR_BAD_ADDRESS;
+             }
+             /* the sensor holds SCL low until the conversion is done */
+             stretch_us = sensor->ready_us - sim->now_us;
+             if (xfer->timeout_us && stretch_us > xfer->timeout_us) {
+                 sim->now_us += xfer->timeout_us;
+                 sim->bus_busy_us += xfer->timeout_us;
+                 return STATUS_ERR_TIMEOUT;
+             }
+             sim->now_us += stretch_us;
+             sim->bus_busy_us += stretch_us;
+         }
+         sensor->busy = false;
+         shtc1_sim_set_result(sensor);
+     }
+ 
+     if (!sensor->response_length) {
+         ++sim->nacks;
+         return STATUS_ERR_BAD_ADDRESS;
+     }
+     memset(xfer->data, 0xff, xfer->length);
+     memcpy(xfer->data, sensor->response,
+             xfer->length < sensor->response_length ? xfer->length : sensor->response_length);
+     sensor->response_length = 0;
+     return STATUS_OK;
+ }
+ 
+ static enum status_code shtc1_sim_write_read(struct shtc1_transport *transport,
+         const struct shtc1_xfer *write, const struct shtc1_xfer *read)
+ {
+     enum status_code ret = shtc1_sim_write(transport, write);
+ 
+     if (ret)
+         return ret;
+     return shtc1_sim_read(transport, read);
+ }
+ 
+ static void shtc1_sim_delay_us(struct shtc1_transport *transport, uint32_t us)
+ {
+     shtc1_sim_from(transport)->now_us += us;
+ }
+ 
+ static uint32_t shtc1_sim_timestamp_us(struct shtc1_transport *transport)
+ {
+     return shtc1_sim_from(transport)->now_us;
+ }
+ 
+ static enum status_code shtc1_sim_write_async(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg)
+ {
+     done(arg, shtc1_sim_write(transport, xfer));
+     return STATUS_OK;
+ }
+ 
+ static enum status_code shtc1_sim_read_async(struct shtc1_transport *transport,
+         const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg)
+ {
+     done(arg, shtc1_sim_read(transport, xfer));
+     return STATUS_OK;
+ }
+ 
+ void shtc1_sim_init(struct shtc1_sim *sim, uint8_t mux_address)
+ {
+     memset(sim, 0, sizeof(*sim));
+     sim->transport.write = shtc1_sim_write;
+     sim->transport.read = shtc1_sim_read;
+     sim->transport.write_read = shtc1_sim_write_read;
+     sim->transport.delay_us = shtc1_sim_delay_us;
+     sim->transport.timestamp_us = shtc1_sim_timestamp_us;
+     sim->transport.recover = NULL;
+     sim->transport.lock = NULL;
+     sim->transport.unlock = NULL;
+     sim->transport.write_async = shtc1_sim_write_async;
+     sim->transport.read_async = shtc1_sim_read_async;
+     sim->speed_khz = SHTC1_SPEED_STANDARD;
+     sim->conversion_us[SHTC1_MODE_LPM] = SIM_CONVERSION_US[SHTC1_MODE_LPM];
+     sim->conversion_us[SHTC1_MODE_HPM] = SIM_CONVERSION_US[SHTC1_MODE_HPM];
+     sim->mux_address = mux_address;
+     /* 25 C, 50 %RH */
+     shtc1_sim_set_signals(sim, 0, 0x6666, 0x8000);
+ }
+ 
+ void shtc1_sim_set_signals(struct shtc1_sim *sim, uint8_t channel,
+         uint16_t raw_t, uint16_t raw_rh)
+ {
+     struct shtc1_sim_sensor *sensor = &sim->sensors[channel];
+ 
+     sensor->present = true;
+     sensor->raw_t = raw_t;
+     sensor->raw_rh = raw_rh;
+ }
+ 
+ uint16_t shtc1_sim_get_utilization(const struct shtc1_sim *sim)
+ {
+     if (!sim->now_us)
+         return 0;
+     return (uint16_t)((uint64_t)sim->bus_busy_us * 1000 / sim->now_us);
+ }
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 simulated transport
+ *
+ * This module implements the driver transport on a simulated bus for host
+ * builds. The bus runs on a virtual microsecond clock and models the sensor
+ * behaviour the driver depends on: the conversion times, the address NACK
+ * while a conversion is running, clock stretching, soft reset, the ID
+ * register and the SHTC3 sleep and wakeup commands. Transfer times follow the bit count at the configured SCL speed,
+ * so the virtual clock and the bus busy time give samples/s and bus
+ * utilization of a measurement strategy without hardware.
+ */
+
+ #ifndef SHTC1_SIM_H_
+ #define SHTC1_SIM_H_
+ 
+ #include "shtc1_transport.h"
+ 
+ /* number of simulated sensors, one per multiplexer channel */
+ #ifndef SHTC1_SIM_SENSORS
+ #define SHTC1_SIM_SENSORS 8
+ #endif
+ 
+ struct shtc1_sim_sensor {
+     /** the sensor acknowledges its address */
+     bool present;
+     /** the sensor is in sleep mode and only accepts the wakeup command */
+     bool asleep;
+     /** virtual time the sensor accepts commands after a wakeup */
+     uint32_t awake_us;
+     /** signals reported by the next measurements */
+     uint16_t raw_t;
+     uint16_t raw_rh;
+     /** number of following results delivered with a corrupted checksum */
+     uint8_t corrupt;
+     /** a conversion is running or its result has not been read */
+     bool busy;
+     /** the running conversion was started with clock stretching */
+     bool stretch;
+     /** virtual time the result of the running conversion becomes ready */
+     uint32_t ready_us;
+     /** bytes returned by the next read */
+     uint8_t response[6];
+     uint8_t response_length;
+ };
+ 
+ struct shtc1_sim {
+     struct shtc1_transport transport;
+     /** virtual clock in microseconds */
+     uint32_t now_us;
+     /** virtual time the bus was occupied by transfers, including clock stretching */
+     uint32_t bus_busy_us;
+     /** number of transfers */
+     uint32_t transfers;
+     /** number of transfers that were not acknowledged */
+     uint32_t nacks;
+     /** configured SCL frequency of the bus in kHz */
+     uint16_t speed_khz;
+     /** conversion times in microseconds, indexed by enum shtc1_mode */
+     uint16_t conversion_us[2];
+     /** address of the simulated multiplexer or SHTC1_NO_MUX */
+     uint8_t mux_address;
+     uint8_t mux_mask;
+     struct shtc1_sim_sensor sensors[SHTC1_SIM_SENSORS];
+ };
+ 
+ /**
+  * Initializes a simulated bus at standard mode with typical conversion times
+  * and a single present sensor. The non-blocking operations complete before
+  * they return.
+  *
+  * @param sim         the simulated bus to initialize
+  * @param mux_address address of a simulated multiplexer in front of the
+  *                    sensors, SHTC1_NO_MUX for a single sensor 0
+  */
+ void shtc1_sim_init(struct shtc1_sim *sim, uint8_t mux_address);
+ 
+ /**
+  * Sets the signals a simulated sensor reports and marks it present.
+  *
+  * @param sim     the simulated bus
+  * @param channel the multiplexer channel of the sensor, 0 without multiplexer
+  * @param raw_t   the temperature signal
+  * @param raw_rh  the humidity signal
+  */
+ void shtc1_sim_set_signals(struct shtc1_sim *sim, uint8_t channel,
+         uint16_t raw_t, uint16_t raw_rh);
+ 
+ /**
+  * Returns the share of the elapsed virtual time the bus was occupied.
+  *
+  * @param sim the simulated bus
+  * @return    the bus utilization in 1/1000
+  */
+ uint16_t shtc1_sim_get_utilization(const struct shtc1_sim *sim);
+ 
+ #endif /* SHTC1_SIM_H_ */
\ No newline at end of file
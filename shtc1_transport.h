@@ -0,0 +1,121 @@
+/*
+ *  Copyright (C) 2013 Sensirion AG, Switzerland
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * \file
+ *
+ * \brief Sensirion SHTC1 driver transport interface
+ *
+ * The driver accesses the I2C bus and the time base only through a transport,
+ * so every platform can plug in its fastest path. A platform implementation
+ * embeds struct shtc1_transport as its first member and fills in the
+ * operations; optional operations are left NULL.
+ */
+
+ #ifndef SHTC1_TRANSPORT_H_
+ #define SHTC1_TRANSPORT_H_
+ 
+ #include <stdbool.h>
+ #include <stddef.h>
+ #include <stdint.h>
+ #include "status_codes.h"
+ 
+ /* the transfer ends without a stop condition, the next one starts with a repeated start */
+ #define SHTC1_XFER_NO_STOP 0x01
+ 
+ /**
+  * A single I2C transfer.
+  */
+ struct shtc1_xfer {
+     /** 7-bit slave address */
+     uint16_t address;
+     /** SHTC1_XFER_* flags */
+     uint8_t flags;
+     /** SCL frequency in kHz, 0 for the configured speed of the bus */
+     uint16_t speed_khz;
+     /** upper bound for the transfer including clock stretching in us, 0 for the default of the transport */
+     uint16_t timeout_us;
+     uint16_t length;
+     uint8_t *data;
+ };
+ 
+ /**
+  * Called when a non-blocking transfer has completed, possibly from interrupt
+  * context.
+  *
+  * @param arg    the argument passed with the transfer
+  * @param status STATUS_OK if the transfer was successful, else an error code.
+  *               A NACK of the address is reported as STATUS_ERR_BAD_ADDRESS.
+  */
+ typedef void (*shtc1_xfer_done_t)(void *arg, enum status_code status);
+ 
+ struct shtc1_transport {
+     /**
+      * Writes xfer->data to the slave and blocks until done.
+      * @return STATUS_OK if the transfer was successful, STATUS_ERR_BAD_ADDRESS
+      *         on an address NACK, else an error code.
+      */
+     enum status_code (*write)(struct shtc1_transport *transport,
+             const struct shtc1_xfer *xfer);
+     /**
+      * Reads xfer->length bytes from the slave and blocks until done.
+      * @return STATUS_OK if the transfer was successful, STATUS_ERR_BAD_ADDRESS
+      *         on an address NACK, else an error code.
+      */
+     enum status_code (*read)(struct shtc1_transport *transport,
+             const struct shtc1_xfer *xfer);
+     /**
+      * Writes, issues a repeated start and reads as one transaction, optional.
+      * The driver falls back to write without stop followed by read if NULL.
+      */
+     enum status_code (*write_read)(struct shtc1_transport *transport,
+             const struct shtc1_xfer *write, const struct shtc1_xfer *read);
+     /** Busy waits or sleeps for at least the given time. */
+     void (*delay_us)(struct shtc1_transport *transport, uint32_t us);
+     /** Returns a free running microsecond timestamp, optional. */
+     uint32_t (*timestamp_us)(struct shtc1_transport *transport);
+     /**
+      * Frees a bus held by a slave by clocking out up to 9 SCL pulses followed
+      * by a stop condition, optional.
+      */
+     enum status_code (*recover)(struct shtc1_transport *transport);
+     /**
+      * Takes exclusive ownership of a bus shared between tasks for a sequence
+      * of transfers, optional. The driver only holds the bus for the command
+      * write and the readout, never during a conversion, and does not nest
+      * locks. Only called from task context.
+      * @return STATUS_OK if the bus was taken, else an error code.
+      */
+     enum status_code (*lock)(struct shtc1_transport *transport);
+     /** Releases the bus taken by lock, must be set if lock is. */
+     void (*unlock)(struct shtc1_transport *transport);
+ 
+     /**
+      * Starts a write and returns immediately, optional. done is called once
+      * the transfer has completed unless an error code is returned.
+      */
+     enum status_code (*write_async)(struct shtc1_transport *transport,
+             const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg);
+     /**
+      * Starts a read and returns immediately, optional. done is called once
+      * the transfer has completed unless an error code is returned.
+      */
+     enum status_code (*read_async)(struct shtc1_transport *transport,
+             const struct shtc1_xfer *xfer, shtc1_xfer_done_t done, void *arg);
+ };
+ 
+ #endif /* SHTC1_TRANSPORT_H_ */